@@ -0,0 +1,309 @@
+#include "flappy_batch.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SIM_BATCH_WIDTH 8
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SIM_BATCH_WIDTH 4
+#else
+#define SIM_BATCH_WIDTH 1
+#endif
+
+// Vector helpers, one set per instruction set
+#if defined(__AVX2__)
+typedef __m256 vfloat;
+typedef __m256i vint;
+static inline vfloat vLoad(const float* p) { return _mm256_load_ps(p); }
+static inline void vStore(float* p, vfloat v) { _mm256_store_ps(p, v); }
+static inline vint vLoadI(const int* p) { return _mm256_load_si256((const __m256i*)p); }
+static inline void vStoreI(int* p, vint v) { _mm256_store_si256((__m256i*)p, v); }
+static inline vfloat vSet(float f) { return _mm256_set1_ps(f); }
+static inline vint vSetI(int i) { return _mm256_set1_epi32(i); }
+static inline vfloat vAdd(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+static inline vfloat vSub(vfloat a, vfloat b) { return _mm256_sub_ps(a, b); }
+static inline vint vLess(vfloat a, vfloat b) { return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_LT_OQ)); }
+static inline vint vSubI(vint a, vint b) { return _mm256_sub_epi32(a, b); }
+static inline vint vGreaterI(vint a, vint b) { return _mm256_cmpgt_epi32(a, b); }
+static inline vint vAnd(vint a, vint b) { return _mm256_and_si256(a, b); }
+static inline vint vAndNot(vint a, vint b) { return _mm256_andnot_si256(a, b); }  // ~a & b
+static inline vint vOr(vint a, vint b) { return _mm256_or_si256(a, b); }
+static inline vfloat vSelect(vint mask, vfloat a, vfloat b) { return _mm256_blendv_ps(b, a, _mm256_castsi256_ps(mask)); }
+static inline vint vSelectI(vint mask, vint a, vint b) { return _mm256_blendv_epi8(b, a, mask); }
+static inline int vMoveMask(vint mask) { return _mm256_movemask_ps(_mm256_castsi256_ps(mask)); }
+#elif defined(__SSE2__)
+typedef __m128 vfloat;
+typedef __m128i vint;
+static inline vfloat vLoad(const float* p) { return _mm_load_ps(p); }
+static inline void vStore(float* p, vfloat v) { _mm_store_ps(p, v); }
+static inline vint vLoadI(const int* p) { return _mm_load_si128((const __m128i*)p); }
+static inline void vStoreI(int* p, vint v) { _mm_store_si128((__m128i*)p, v); }
+static inline vfloat vSet(float f) { return _mm_set1_ps(f); }
+static inline vint vSetI(int i) { return _mm_set1_epi32(i); }
+static inline vfloat vAdd(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+static inline vfloat vSub(vfloat a, vfloat b) { return _mm_sub_ps(a, b); }
+static inline vint vLess(vfloat a, vfloat b) { return _mm_castps_si128(_mm_cmplt_ps(a, b)); }
+static inline vint vSubI(vint a, vint b) { return _mm_sub_epi32(a, b); }
+static inline vint vGreaterI(vint a, vint b) { return _mm_cmpgt_epi32(a, b); }
+static inline vint vAnd(vint a, vint b) { return _mm_and_si128(a, b); }
+static inline vint vAndNot(vint a, vint b) { return _mm_andnot_si128(a, b); }  // ~a & b
+static inline vint vOr(vint a, vint b) { return _mm_or_si128(a, b); }
+static inline vint vSelectI(vint mask, vint a, vint b) { return vOr(vAnd(mask, a), vAndNot(mask, b)); }
+static inline vfloat vSelect(vint mask, vfloat a, vfloat b) {
+    return _mm_castsi128_ps(vSelectI(mask, _mm_castps_si128(a), _mm_castps_si128(b)));
+}
+static inline int vMoveMask(vint mask) { return _mm_movemask_ps(_mm_castsi128_ps(mask)); }
+#endif
+
+const char* simBatchBackend() {
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(__SSE2__)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+// Allocate a zeroed array aligned for vector loads
+static void* allocLanes(int count, size_t size) {
+    void* p = NULL;
+    if (posix_memalign(&p, 32, (size_t)count * size) != 0) {
+        return NULL;
+    }
+    memset(p, 0, (size_t)count * size);
+    return p;
+}
+
+bool simBatchInit(SimBatch& batch, int count, const unsigned int* seeds) {
+    batch.count = count;
+    batch.stride = (count + SIM_BATCH_WIDTH - 1) / SIM_BATCH_WIDTH * SIM_BATCH_WIDTH;
+
+    int n = batch.stride;
+    batch.birdY = (float*)allocLanes(n, sizeof(float));
+    batch.birdVelocity = (float*)allocLanes(n, sizeof(float));
+    batch.score = (int*)allocLanes(n, sizeof(int));
+    batch.highScore = (int*)allocLanes(n, sizeof(int));
+    batch.dead = (int*)allocLanes(n, sizeof(int));
+    batch.flap = (int*)allocLanes(n, sizeof(int));
+    batch.rng = (Random*)allocLanes(n, sizeof(Random));
+    batch.pipeX = (float*)allocLanes(n * MAX_PIPES, sizeof(float));
+    batch.pipeGapY = (float*)allocLanes(n * MAX_PIPES, sizeof(float));
+    batch.pipeCounted = (int*)allocLanes(n * MAX_PIPES, sizeof(int));
+    if (!batch.birdY || !batch.birdVelocity || !batch.score || !batch.highScore ||
+        !batch.dead || !batch.flap || !batch.rng || !batch.pipeX || !batch.pipeGapY ||
+        !batch.pipeCounted) {
+        simBatchFree(batch);  // Frees the arrays that did allocate
+        return false;
+    }
+
+    for (int w = 0; w < count; w++) {
+        randomSeed(batch.rng[w], seeds[w], RANDOM_STREAM_LEVEL);
+        simBatchResetWorld(batch, w);
+    }
+
+    // Padding lanes stay dead so they never change
+    for (int w = count; w < n; w++) {
+        batch.dead[w] = -1;
+    }
+    return true;
+}
+
+void simBatchFree(SimBatch& batch) {
+    free(batch.birdY);
+    free(batch.birdVelocity);
+    free(batch.score);
+    free(batch.highScore);
+    free(batch.dead);
+    free(batch.flap);
+    free(batch.rng);
+    free(batch.pipeX);
+    free(batch.pipeGapY);
+    free(batch.pipeCounted);
+    memset(&batch, 0, sizeof(batch));
+}
+
+void simBatchResetWorld(SimBatch& batch, int w) {
+    int n = batch.stride;
+    batch.birdY[w] = WINDOW_HEIGHT / 2;
+    batch.birdVelocity[w] = 0;
+    batch.score[w] = 0;
+    batch.dead[w] = 0;
+    batch.flap[w] = 0;
+
+    // Reset pipes with proper spacing
+    for (int i = 0; i < MAX_PIPES; i++) {
+        batch.pipeX[i * n + w] = WINDOW_WIDTH + (i * PIPE_SPACING);
+        batch.pipeGapY[i * n + w] = simRandomGapY(batch.rng[w]);
+        batch.pipeCounted[i * n + w] = 0;
+    }
+}
+
+// Move pipe i of world w after the rightmost pipe, which is the one before
+// it: the slots form a ring in level order, as in simStep()
+static void recyclePipe(SimBatch& batch, int i, int w) {
+    int n = batch.stride;
+    int tail = (i + MAX_PIPES - 1) % MAX_PIPES;
+    batch.pipeX[i * n + w] = batch.pipeX[tail * n + w] + PIPE_SPACING;
+    batch.pipeGapY[i * n + w] = simRandomGapY(batch.rng[w]);
+    batch.pipeCounted[i * n + w] = 0;
+}
+
+#if SIM_BATCH_WIDTH > 1
+
+void simBatchStep(SimBatch& batch) {
+    int n = batch.stride;
+    const float birdX = WINDOW_WIDTH / 4;
+
+    for (int w = 0; w < n; w += SIM_BATCH_WIDTH) {
+        vint alive = vAndNot(vLoadI(batch.dead + w), vSetI(-1));
+        vint flap = vAnd(vGreaterI(vLoadI(batch.flap + w), vSetI(0)), alive);
+
+        // Update bird position
+        vfloat velocity = vLoad(batch.birdVelocity + w);
+        velocity = vSelect(flap, vSet(FLAP_VELOCITY), velocity);
+        velocity = vSelect(alive, vAdd(velocity, vSet(GRAVITY)), velocity);
+        vfloat y = vLoad(batch.birdY + w);
+        y = vSelect(alive, vAdd(y, velocity), y);
+        vStore(batch.birdVelocity + w, velocity);
+        vStore(batch.birdY + w, y);
+
+        // Move pipes
+        vint score = vLoadI(batch.score + w);
+        for (int i = 0; i < MAX_PIPES; i++) {
+            float* px = batch.pipeX + i * n + w;
+            int* pc = batch.pipeCounted + i * n + w;
+
+            vfloat x = vLoad(px);
+            x = vSelect(alive, vSub(x, vSet(PIPE_SPEED)), x);
+            vfloat right = vAdd(x, vSet(PIPE_WIDTH));
+
+            // Check if bird passed a pipe
+            vint counted = vLoadI(pc);
+            vint passed = vAnd(vAndNot(counted, vLess(right, vSet(birdX))), alive);
+            score = vSubI(score, passed);
+            vStoreI(pc, vOr(counted, passed));
+            vStore(px, x);
+        }
+        vStoreI(batch.score + w, score);
+
+        // Reset pipes that went off screen once all have moved (rare, done
+        // per lane)
+        for (int i = 0; i < MAX_PIPES; i++) {
+            vfloat right = vAdd(vLoad(batch.pipeX + i * n + w), vSet(PIPE_WIDTH));
+            int offscreen = vMoveMask(vAnd(vLess(right, vSet(0.0f)), alive));
+            while (offscreen) {
+                int lane = __builtin_ctz(offscreen);
+                offscreen &= offscreen - 1;
+                recyclePipe(batch, i, w + lane);
+            }
+        }
+
+        // Update high score
+        vint highScore = vLoadI(batch.highScore + w);
+        vStoreI(batch.highScore + w, vSelectI(vGreaterI(score, highScore), score, highScore));
+
+        // Check for collisions
+        vint hit = vOr(vLess(y, vSet(0.0f)), vLess(vSet(WINDOW_HEIGHT - GROUND_HEIGHT), y));
+        vfloat birdTop = vSub(y, vSet(BIRD_SIZE));
+        vfloat birdBottom = vAdd(y, vSet(BIRD_SIZE));
+        for (int i = 0; i < MAX_PIPES; i++) {
+            vfloat x = vLoad(batch.pipeX + i * n + w);
+            vfloat gapY = vLoad(batch.pipeGapY + i * n + w);
+            vint overlapX = vAnd(vLess(x, vSet(birdX + BIRD_SIZE)),
+                                 vLess(vSet(birdX - BIRD_SIZE), vAdd(x, vSet(PIPE_WIDTH))));
+            vint outsideGap = vOr(vLess(birdTop, vSub(gapY, vSet(PIPE_GAP/2))),
+                                  vLess(vAdd(gapY, vSet(PIPE_GAP/2)), birdBottom));
+            hit = vOr(hit, vAnd(overlapX, outsideGap));
+        }
+        vStoreI(batch.dead + w, vOr(vLoadI(batch.dead + w), vAnd(hit, alive)));
+        vStoreI(batch.flap + w, vSetI(0));
+    }
+}
+
+#else
+
+void simBatchStep(SimBatch& batch) {
+    int n = batch.stride;
+    const float birdX = WINDOW_WIDTH / 4;
+
+    for (int w = 0; w < batch.count; w++) {
+        if (batch.dead[w]) {
+            batch.flap[w] = 0;
+            continue;
+        }
+
+        // Update bird position
+        if (batch.flap[w]) {
+            batch.birdVelocity[w] = FLAP_VELOCITY;
+        }
+        batch.birdVelocity[w] += GRAVITY;
+        batch.birdY[w] += batch.birdVelocity[w];
+        float y = batch.birdY[w];
+
+        // Move pipes
+        for (int i = 0; i < MAX_PIPES; i++) {
+            batch.pipeX[i * n + w] -= PIPE_SPEED;
+            float x = batch.pipeX[i * n + w];
+            if (!batch.pipeCounted[i * n + w] && x + PIPE_WIDTH < birdX) {
+                batch.score[w]++;
+                batch.pipeCounted[i * n + w] = -1;
+            }
+        }
+        for (int i = 0; i < MAX_PIPES; i++) {
+            if (batch.pipeX[i * n + w] + PIPE_WIDTH < 0) {
+                recyclePipe(batch, i, w);
+            }
+        }
+        if (batch.score[w] > batch.highScore[w]) {
+            batch.highScore[w] = batch.score[w];
+        }
+
+        // Check for collisions
+        bool hit = y < 0 || y > WINDOW_HEIGHT - GROUND_HEIGHT;
+        for (int i = 0; i < MAX_PIPES; i++) {
+            float x = batch.pipeX[i * n + w];
+            float gapY = batch.pipeGapY[i * n + w];
+            if (x < birdX + BIRD_SIZE && x + PIPE_WIDTH > birdX - BIRD_SIZE) {
+                if (y - BIRD_SIZE < gapY - PIPE_GAP/2 || y + BIRD_SIZE > gapY + PIPE_GAP/2) {
+                    hit = true;
+                }
+            }
+        }
+        batch.dead[w] = hit ? -1 : 0;
+        batch.flap[w] = 0;
+    }
+}
+
+#endif
+
+void simBatchGetWorld(const SimBatch& batch, int w, SimState& state) {
+    int n = batch.stride;
+    memset(&state, 0, sizeof(state));
+    state.birdX = WINDOW_WIDTH / 4;
+    state.birdY = batch.birdY[w];
+    state.birdVelocity = batch.birdVelocity[w];
+    state.birdRotation = state.birdVelocity * 3;
+    if (state.birdRotation > 60) state.birdRotation = 60;
+    if (state.birdRotation < -60) state.birdRotation = -60;
+    // Default level, unscrolled: screen x is level x, and the ring starts
+    // at the leftmost slot
+    state.pipeCount = MAX_PIPES;
+    state.basePipeCount = MAX_PIPES;
+    state.pipeSpacing = PIPE_SPACING;
+    for (int i = 0; i < MAX_PIPES; i++) {
+        state.pipes[i].x = batch.pipeX[i * n + w];
+        state.pipes[i].gapY = batch.pipeGapY[i * n + w];
+        state.pipes[i].gap = PIPE_GAP;
+        state.pipes[i].counted = batch.pipeCounted[i * n + w] != 0;
+        if (state.pipes[i].x < state.pipes[state.pipeHead].x) {
+            state.pipeHead = i;
+        }
+    }
+    state.score = batch.score[w];
+    state.highScore = batch.highScore[w];
+    state.dead = batch.dead[w] != 0;
+    state.rng = batch.rng[w];
+}
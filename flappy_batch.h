@@ -0,0 +1,49 @@
+// Batched multi-world simulation
+// Steps many independent games at once. Bird and pipe data are stored as
+// structure-of-arrays so the physics, scrolling and collision tests run
+// across SIMD lanes (AVX2 or SSE2, with a scalar fallback). Every world
+// follows exactly the same rules, and float results, as simStep() in the
+// default level (MAX_PIPES pipes, PIPE_SPACING apart).
+#ifndef FLAPPY_BATCH_H
+#define FLAPPY_BATCH_H
+
+#include "flappy_sim.h"
+
+struct SimBatch {
+    int count;   // number of worlds
+    int stride;  // count rounded up to the SIMD width
+
+    // Per-world arrays, length stride
+    float* birdY;
+    float* birdVelocity;
+    int* score;
+    int* highScore;
+    int* dead;     // 0 or -1 (lane mask)
+    int* flap;     // input for the next step, set to non-zero to flap
+    Random* rng;  // Level stream per world
+
+    // Per-pipe arrays, pipe i of world w at [i * stride + w]
+    float* pipeX;
+    float* pipeGapY;
+    int* pipeCounted;  // 0 or -1 (lane mask)
+};
+
+// Name of the vector path compiled in ("avx2", "sse2" or "scalar")
+const char* simBatchBackend();
+
+// Allocate count worlds; world w starts like simInit(state, seeds[w]).
+// False, with nothing allocated, if memory runs out.
+bool simBatchInit(SimBatch& batch, int count, const unsigned int* seeds);
+void simBatchFree(SimBatch& batch);
+
+// Start a new run in one world, keeping its high score (like simReset)
+void simBatchResetWorld(SimBatch& batch, int w);
+
+// Advance every live world by one tick using batch.flap as input;
+// flap flags are cleared afterwards
+void simBatchStep(SimBatch& batch);
+
+// Copy one world into a scalar state (milestones are not tracked)
+void simBatchGetWorld(const SimBatch& batch, int w, SimState& state);
+
+#endif
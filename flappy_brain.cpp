@@ -0,0 +1,77 @@
+#include "flappy_brain.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#define BRAIN_FILE_HEADER "flappy-brain"
+#define BRAIN_FILE_VERSION 1
+
+void brainObserve(const SimState& state, float* inputs) {
+    // Next pipe to fly through and the one after it
+    int next = 0;
+    while (next < state.pipeCount &&
+           simPipeX(state, simPipe(state, next)) + PIPE_WIDTH < state.birdX - BIRD_SIZE) {
+        next++;
+    }
+    float pipeX = WINDOW_WIDTH, gapY = WINDOW_HEIGHT / 2, afterGapY = WINDOW_HEIGHT / 2;
+    if (next < state.pipeCount) {
+        pipeX = simPipeX(state, simPipe(state, next));
+        gapY = simPipe(state, next).gapY;
+    }
+    if (next + 1 < state.pipeCount) {
+        afterGapY = simPipe(state, next + 1).gapY;
+    }
+
+    inputs[0] = state.birdY / WINDOW_HEIGHT * 2 - 1;
+    inputs[1] = state.birdVelocity / 10;
+    inputs[2] = (pipeX - state.birdX) / WINDOW_WIDTH;
+    inputs[3] = (gapY - state.birdY) / (WINDOW_HEIGHT / 2);
+    inputs[4] = (afterGapY - state.birdY) / (WINDOW_HEIGHT / 2);
+}
+
+bool brainWantsFlap(const Brain& brain, const SimState& state) {
+    float inputs[BRAIN_INPUTS];
+    brainObserve(state, inputs);
+
+    const float* w = brain.weights;
+    const float* out = brain.weights + (BRAIN_INPUTS + 1) * BRAIN_HIDDEN;
+    float output = out[BRAIN_HIDDEN];
+    for (int h = 0; h < BRAIN_HIDDEN; h++) {
+        float sum = w[BRAIN_INPUTS];
+        for (int i = 0; i < BRAIN_INPUTS; i++) {
+            sum += w[i] * inputs[i];
+        }
+        output += out[h] * (sum / (1 + fabsf(sum)));  // Softsign
+        w += BRAIN_INPUTS + 1;
+    }
+    return output > 0;
+}
+
+bool brainSave(const Brain& brain, const char* path) {
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        return false;
+    }
+    fprintf(f, "%s %d %d %d\n", BRAIN_FILE_HEADER, BRAIN_FILE_VERSION, BRAIN_INPUTS, BRAIN_HIDDEN);
+    for (int i = 0; i < BRAIN_WEIGHTS; i++) {
+        fprintf(f, "%.9g\n", brain.weights[i]);
+    }
+    return fclose(f) == 0;
+}
+
+bool brainLoad(Brain& brain, const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        return false;
+    }
+    char header[32];
+    int version = 0, inputs = 0, hidden = 0;
+    bool ok = fscanf(f, "%31s %d %d %d", header, &version, &inputs, &hidden) == 4 &&
+              strcmp(header, BRAIN_FILE_HEADER) == 0 && version == BRAIN_FILE_VERSION &&
+              inputs == BRAIN_INPUTS && hidden == BRAIN_HIDDEN;
+    for (int i = 0; ok && i < BRAIN_WEIGHTS; i++) {
+        ok = fscanf(f, "%f", &brain.weights[i]) == 1 && isfinite(brain.weights[i]);
+    }
+    fclose(f);
+    return ok;
+}
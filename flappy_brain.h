@@ -0,0 +1,34 @@
+// Neural-net policy
+// A small fixed-size network that decides from the simulation state
+// whether the bird flaps on the next tick: one hidden layer with softsign
+// activation (x / (1 + |x|), as tanh but without a libm call). Weights are
+// evolved by flappy_train and stored as text, one weight per line, so the
+// game can load the best genome as an autopilot.
+#ifndef FLAPPY_BRAIN_H
+#define FLAPPY_BRAIN_H
+
+#include "flappy_sim.h"
+
+// Observations: bird height and velocity, and the next pipe's distance
+// and gap offset, plus the gap offset of the pipe after it
+#define BRAIN_INPUTS 5
+#define BRAIN_HIDDEN 8
+// Hidden layer weights and biases, then the output weights and bias
+#define BRAIN_WEIGHTS ((BRAIN_INPUTS + 1) * BRAIN_HIDDEN + BRAIN_HIDDEN + 1)
+
+struct Brain {
+    float weights[BRAIN_WEIGHTS];
+};
+
+// Fill the network's inputs from a state, each scaled to about [-1, 1]
+void brainObserve(const SimState& state, float* inputs);
+
+// Whether the policy flaps in this state
+bool brainWantsFlap(const Brain& brain, const SimState& state);
+
+bool brainSave(const Brain& brain, const char* path);
+
+// False if the file is missing or not a brain of this shape
+bool brainLoad(Brain& brain, const char* path);
+
+#endif
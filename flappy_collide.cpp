@@ -0,0 +1,106 @@
+#include "flappy_collide.h"
+#include <math.h>
+
+struct Vec2 {
+    float x, y;
+};
+
+static inline Vec2 vec2(float x, float y) {
+    Vec2 v = {x, y};
+    return v;
+}
+
+// Twice the signed area of the triangle o, a, b
+static inline float cross(Vec2 o, Vec2 a, Vec2 b) {
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+static float pointSegmentDistance2(Vec2 p, Vec2 a, Vec2 b) {
+    float dx = b.x - a.x, dy = b.y - a.y;
+    float length2 = dx * dx + dy * dy;
+    float t = 0;
+    if (length2 > 0) {
+        t = ((p.x - a.x) * dx + (p.y - a.y) * dy) / length2;
+        if (t < 0) t = 0;
+        if (t > 1) t = 1;
+    }
+    float ex = a.x + t * dx - p.x, ey = a.y + t * dy - p.y;
+    return ex * ex + ey * ey;
+}
+
+// Whether segments ab and cd cross at a point inside both
+static inline bool segmentsCross(Vec2 a, Vec2 b, Vec2 c, Vec2 d) {
+    float d1 = cross(c, d, a), d2 = cross(c, d, b);
+    float d3 = cross(a, b, c), d4 = cross(a, b, d);
+    return ((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) &&
+           ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0));
+}
+
+// Whether p is inside the convex quad q (either winding)
+static bool insideQuad(Vec2 p, const Vec2* q) {
+    bool negative = false, positive = false;
+    for (int i = 0; i < 4; i++) {
+        float side = cross(q[i], q[(i + 1) & 3], p);
+        negative = negative || side < 0;
+        positive = positive || side > 0;
+    }
+    return !(negative && positive);
+}
+
+// Squared distance between segment ab and the convex quad q
+static float segmentQuadDistance2(Vec2 a, Vec2 b, const Vec2* q) {
+    if (insideQuad(a, q)) {
+        return 0;
+    }
+    float best = pointSegmentDistance2(q[0], a, b);
+    for (int i = 0; i < 4; i++) {
+        Vec2 c = q[i], d = q[(i + 1) & 3];
+        if (segmentsCross(a, b, c, d)) {
+            return 0;
+        }
+        float e;
+        if ((e = pointSegmentDistance2(a, c, d)) < best) best = e;
+        if ((e = pointSegmentDistance2(b, c, d)) < best) best = e;
+        if ((e = pointSegmentDistance2(d, a, b)) < best) best = e;
+    }
+    return best;
+}
+
+bool collideSweptEllipse(const CollideSweep& sweep, const CollideRect* rects, int count) {
+    float radians = sweep.angle * (float)M_PI / 180.0f;
+    float c = cosf(radians), s = sinf(radians);
+
+    // Half extents of the rotated ellipse's bounding box, for a cheap
+    // rejection of rectangles away from the path
+    float halfX = sqrtf(sweep.radiusX * c * sweep.radiusX * c + sweep.radiusY * s * sweep.radiusY * s);
+    float halfY = sqrtf(sweep.radiusX * s * sweep.radiusX * s + sweep.radiusY * c * sweep.radiusY * c);
+    float minX = fminf(sweep.fromX, sweep.toX) - halfX, maxX = fmaxf(sweep.fromX, sweep.toX) + halfX;
+    float minY = fminf(sweep.fromY, sweep.toY) - halfY, maxY = fmaxf(sweep.fromY, sweep.toY) + halfY;
+
+    // Ellipse space: undo the rotation, then scale the radii to 1, with
+    // the end position at the origin
+    float ax = c / sweep.radiusX, ay = s / sweep.radiusX;
+    float bx = -s / sweep.radiusY, by = c / sweep.radiusY;
+    float fx = sweep.fromX - sweep.toX, fy = sweep.fromY - sweep.toY;
+    Vec2 from = vec2(ax * fx + ay * fy, bx * fx + by * fy);
+    Vec2 to = vec2(0, 0);
+
+    for (int i = 0; i < count; i++) {
+        const CollideRect& r = rects[i];
+        if (r.x1 >= maxX || r.x2 <= minX || r.y1 >= maxY || r.y2 <= minY) {
+            continue;
+        }
+        float x1 = r.x1 - sweep.toX, x2 = r.x2 - sweep.toX;
+        float y1 = r.y1 - sweep.toY, y2 = r.y2 - sweep.toY;
+        Vec2 quad[4] = {
+            vec2(ax * x1 + ay * y1, bx * x1 + by * y1),
+            vec2(ax * x2 + ay * y1, bx * x2 + by * y1),
+            vec2(ax * x2 + ay * y2, bx * x2 + by * y2),
+            vec2(ax * x1 + ay * y2, bx * x1 + by * y2)
+        };
+        if (segmentQuadDistance2(from, to, quad) < 1) {
+            return true;
+        }
+    }
+    return false;
+}
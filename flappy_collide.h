@@ -0,0 +1,32 @@
+// Swept ellipse collision
+// Exact test of a rotated ellipse moving along a straight line against
+// axis-aligned rectangles. The problem is mapped into the ellipse's own
+// space, where the ellipse is the unit circle and each rectangle a
+// parallelogram; the ellipse touches a rectangle somewhere along its path
+// exactly when the path segment passes within distance 1 of the
+// parallelogram. Nothing is sampled, so a fast move cannot tunnel through
+// a thin rectangle between two positions.
+#ifndef FLAPPY_COLLIDE_H
+#define FLAPPY_COLLIDE_H
+
+// Axis-aligned rectangle, x1 < x2 and y1 < y2
+struct CollideRect {
+    float x1, y1;
+    float x2, y2;
+};
+
+// Ellipse with the given radii, rotated by angle degrees (as batchRotatef()),
+// whose centre moves from (fromX, fromY) to (toX, toY) in the rectangles'
+// frame
+struct CollideSweep {
+    float fromX, fromY;
+    float toX, toY;
+    float radiusX, radiusY;
+    float angle;
+};
+
+// Whether the ellipse overlaps any of the rectangles anywhere along its
+// path (touching edges do not count)
+bool collideSweptEllipse(const CollideSweep& sweep, const CollideRect* rects, int count);
+
+#endif
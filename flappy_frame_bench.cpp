@@ -0,0 +1,458 @@
+// Offscreen frame check and benchmark (EGL, e.g. Mesa llvmpipe)
+// Drives the game scene with scripted input and renders it without a
+// window. --check compares a frame of every screen with the golden images,
+// --update writes new ones, and the default run reports the render time of
+// each frame over scripted sessions of every game state. --idle runs the
+// game loop in real time on every screen, first redrawing every
+// PACING_ACTIVE_MS as the game used to and then with the idle-aware pacing
+// (flappy_time.h), and reports the frame rate and CPU use of each.
+// --pacing plays in real time under each busy pacing mode and reports
+// the achieved frame intervals, their jitter and how late frames started.
+// A pbuffer has no display to sync to, so vsync mode is not measured.
+// --ghosts times the playing screen racing growing crowds of bot ghosts
+// (flappy_ghost.h), up to count.
+//
+// Frames are drawn with the shader effects (flappy_render.h) when the
+// context runs them, or with --fixed-function (before the mode) without.
+// The golden images of the shader path are in the golden directory and
+// those of the fixed-function path in its fixed subdirectory; --check and
+// --update cover both.
+//
+// Golden images are binary PPMs at half resolution (2x2 averaged). A pixel
+// differs when any channel is off by more than GOLDEN_CHANNEL_TOLERANCE; a
+// frame fails when more than GOLDEN_PIXEL_TOLERANCE of its pixels differ,
+// and the frame is then written next to the golden image as NAME.actual.ppm.
+//
+// Usage: flappy_frame_bench [--fixed-function] [mode] ...
+//        flappy_frame_bench [frames]
+//        flappy_frame_bench --check [dir]    compare with dir (default golden)
+//        flappy_frame_bench --update [dir]   rewrite the golden images
+//        flappy_frame_bench --idle [seconds] [idle fps]  CPU use per screen
+//        flappy_frame_bench --pacing [seconds]           frame pacing per mode
+//        flappy_frame_bench --ghosts [count] [frames]    ghost racing frame time
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include "flappy_sim.h"
+#include "flappy_particles.h"
+#include "flappy_render.h"
+#include "flappy_text.h"
+#include "flappy_scene.h"
+#include "flappy_offscreen.h"
+#include "flappy_time.h"
+
+#define SESSION_SEED 12345
+#define SESSION_ALPHA 0.5f  // Halfway between ticks, to exercise interpolation
+#define GOLDEN_WIDTH (WINDOW_WIDTH / 2)
+#define GOLDEN_HEIGHT (WINDOW_HEIGHT / 2)
+#define GOLDEN_CHANNEL_TOLERANCE 8
+#define GOLDEN_PIXEL_TOLERANCE 0.001
+#define GOLDEN_GHOSTS 200
+
+static int sessionGhosts = 0;  // Bot ghosts raced in every session
+
+static int sessionTick = 0;
+
+// Scripted bot: flap when falling below the centre of the next gap
+static bool botWantsFlap(const SimState& state) {
+    const Pipe* next = simNextPipe(state);
+    float targetY = next ? next->gapY + 10 : WINDOW_HEIGHT / 2;
+    return state.birdY > targetY && state.birdVelocity >= 0;
+}
+
+// Fresh scene on the given screen, with the same random streams every time
+static void startSession(GameState state) {
+    sceneReset(SESSION_SEED);
+    sessionTick = 0;
+    if (sessionGhosts > 0) {
+        sceneRace(NULL);
+        ghostRecordBots(ghosts, sessionGhosts, SESSION_SEED, NULL);
+    } else if (racing) {
+        sceneStopRace();
+    }
+    currentState = state;
+    if (state == PLAYING) {
+        resetGame();
+    }
+}
+
+// Advance one tick; while playing, the bot presses space like keyboard() does
+static void stepSession(bool useBot) {
+    if (currentState == PLAYING && useBot && botWantsFlap(sim)) {
+        sceneFlap();
+    }
+    tick();
+    sessionTick++;
+}
+
+static void renderSession() {
+    sceneRender(sessionTick * 16, SESSION_ALPHA);
+}
+
+// Read the frame back at half resolution, top row first
+static void readFrame(unsigned char* image) {
+    static unsigned char pixels[WINDOW_WIDTH * WINDOW_HEIGHT * 3];
+    glFinish();
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    for (int y = 0; y < GOLDEN_HEIGHT; y++) {
+        const unsigned char* row = pixels + (WINDOW_HEIGHT - 2 - 2 * y) * WINDOW_WIDTH * 3;
+        for (int x = 0; x < GOLDEN_WIDTH; x++) {
+            for (int c = 0; c < 3; c++) {
+                int i = x * 6 + c;
+                int sum = row[i] + row[i + 3] + row[i + WINDOW_WIDTH * 3] + row[i + WINDOW_WIDTH * 3 + 3];
+                image[(y * GOLDEN_WIDTH + x) * 3 + c] = (unsigned char)((sum + 2) / 4);
+            }
+        }
+    }
+}
+
+static bool writePPM(const char* path, const unsigned char* image) {
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "cannot write %s\n", path);
+        return false;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", GOLDEN_WIDTH, GOLDEN_HEIGHT);
+    fwrite(image, 1, GOLDEN_WIDTH * GOLDEN_HEIGHT * 3, f);
+    fclose(f);
+    return true;
+}
+
+static bool readPPM(const char* path, unsigned char* image) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return false;
+    }
+    int width = 0, height = 0, maxValue = 0;
+    bool ok = fscanf(f, "P6 %d %d %d", &width, &height, &maxValue) == 3 &&
+              width == GOLDEN_WIDTH && height == GOLDEN_HEIGHT && maxValue == 255 &&
+              fgetc(f) != EOF &&
+              fread(image, 1, GOLDEN_WIDTH * GOLDEN_HEIGHT * 3, f) == GOLDEN_WIDTH * GOLDEN_HEIGHT * 3;
+    fclose(f);
+    return ok;
+}
+
+// Check (or with update, save) the current frame against dir/name.ppm
+static bool goldenFrame(const char* dir, const char* name, bool update) {
+    static unsigned char actual[GOLDEN_WIDTH * GOLDEN_HEIGHT * 3];
+    static unsigned char expected[GOLDEN_WIDTH * GOLDEN_HEIGHT * 3];
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.ppm", dir, name);
+
+    renderSession();
+    readFrame(actual);
+
+    if (update) {
+        if (!writePPM(path, actual)) {
+            return false;
+        }
+        printf("%-14s written %s\n", name, path);
+        return true;
+    }
+
+    if (!readPPM(path, expected)) {
+        printf("%-14s FAIL  no golden image %s (run --update)\n", name, path);
+        return false;
+    }
+
+    int differing = 0, maxDiff = 0;
+    for (int i = 0; i < GOLDEN_WIDTH * GOLDEN_HEIGHT; i++) {
+        int diff = 0;
+        for (int c = 0; c < 3; c++) {
+            diff = std::max(diff, abs(actual[i * 3 + c] - expected[i * 3 + c]));
+        }
+        if (diff > GOLDEN_CHANNEL_TOLERANCE) {
+            differing++;
+        }
+        maxDiff = std::max(maxDiff, diff);
+    }
+
+    bool ok = differing <= GOLDEN_WIDTH * GOLDEN_HEIGHT * GOLDEN_PIXEL_TOLERANCE;
+    printf("%-14s %s  %d pixels differ, max channel diff %d\n", name, ok ? "ok  " : "FAIL",
+           differing, maxDiff);
+    if (!ok) {
+        snprintf(path, sizeof(path), "%s/%s.actual.ppm", dir, name);
+        writePPM(path, actual);
+    }
+    return ok;
+}
+
+// One frame of every screen, after a scripted stretch of play
+static int checkGolden(const char* dir, bool update) {
+    int failures = 0;
+
+    startSession(MENU);
+    for (int i = 0; i < 30; i++) stepSession(false);
+    failures += !goldenFrame(dir, "menu", update);
+    menuSelection = 1;
+    failures += !goldenFrame(dir, "menu_exit", update);
+
+    startSession(INSTRUCTIONS);
+    for (int i = 0; i < 30; i++) stepSession(false);
+    failures += !goldenFrame(dir, "instructions", update);
+
+    startSession(PLAYING);
+    for (int i = 0; i < 240; i++) stepSession(true);
+    failures += !goldenFrame(dir, "playing", update);
+
+    // Keep playing into the first milestone, then stop flapping
+    while (currentState == PLAYING && !(sim.isCelebrating && sim.celebrationTimer < 1.5f)) {
+        stepSession(true);
+    }
+    failures += !goldenFrame(dir, "celebration", update);
+    while (currentState == PLAYING) stepSession(false);
+    for (int i = 0; i < 10; i++) stepSession(false);
+    failures += !goldenFrame(dir, "game_over", update);
+
+    sessionGhosts = GOLDEN_GHOSTS;
+    startSession(PLAYING);
+    for (int i = 0; i < 240; i++) stepSession(true);
+    failures += !goldenFrame(dir, "ghosts", update);
+    sessionGhosts = 0;
+
+    if (!update) {
+        printf("%s\n", failures ? "golden check FAILED" : "golden check passed");
+    }
+    return failures ? 1 : 0;
+}
+
+// Time every frame of a scripted session on one screen
+static void benchSession(const char* name, GameState state, int frames) {
+    startSession(state);
+    if (state == GAME_OVER) {
+        // Crash into the ground first, so the pipes and particles are real
+        currentState = PLAYING;
+        resetGame();
+        while (currentState == PLAYING) stepSession(false);
+    }
+
+    double* times = (double*)malloc(frames * sizeof(double));
+    double total = 0;
+    RenderStats stats = {0, 0, 0, 0};
+    for (int f = -2; f < frames; f++) {  // two warmup frames
+        stepSession(true);
+        if (state == PLAYING && currentState != PLAYING) {
+            resetGame();
+            currentState = PLAYING;
+        }
+        glFinish();
+        renderStatsReset();
+        double start = timeNow();
+        renderSession();
+        glFinish();
+        double elapsed = timeNow() - start;
+        if (f >= 0) {
+            times[f] = elapsed;
+            total += elapsed;
+            stats.glCalls += renderStats.glCalls;
+            stats.drawCalls += renderStats.drawCalls;
+            stats.vertices += renderStats.vertices;
+        }
+    }
+
+    std::sort(times, times + frames);
+    printf("%-13s %6d  %7.3f  %7.3f  %7.3f  %7.3f  %8d  %5d  %8d\n", name, frames,
+           total / frames * 1000, times[frames / 2] * 1000, times[frames * 95 / 100] * 1000,
+           times[frames - 1] * 1000, stats.glCalls / frames, stats.drawCalls / frames,
+           stats.vertices / frames);
+    free(times);
+}
+
+// Live the game loop for seconds of real time on one screen, sleeping
+// between frames as the game's timer does, with or without pacing; reports
+// frames per second and the CPU time used per second
+static void idleSession(const char* name, GameState state, double seconds, int idleFps) {
+    printf("%-13s", name);
+    for (int paced = 0; paced < 2; paced++) {
+        startSession(state);
+        if (state == GAME_OVER) {
+            // Crash into the ground first, so the burst is real
+            currentState = PLAYING;
+            resetGame();
+            while (currentState == PLAYING) stepSession(false);
+        }
+        FixedStep loop;
+        fixedStepInit(loop, SIM_DT, 0.25);
+        Pacing pacing;
+        pacingInit(pacing, idleFps);
+
+        long frames = 0;
+        double start = timeNow(), last = start;
+        clock_t cpuStart = clock();
+        while (timeNow() - start < seconds) {
+            double now = timeNow();
+            int ticks = fixedStepAdvance(loop, now - last);
+            last = now;
+            for (int i = 0; i < ticks; i++) {
+                stepSession(true);
+                if (state == PLAYING && currentState != PLAYING) {
+                    resetGame();
+                    currentState = PLAYING;
+                }
+            }
+            sceneRender((int)((now - start) * 1000), fixedStepAlpha(loop));
+            glFinish();
+            frames++;
+
+            int delay = paced ? pacingNextFrameMs(pacing, sceneBusy()) : PACING_ACTIVE_MS;
+            double left = seconds - (timeNow() - start);
+            if (delay < 0 || delay > left * 1000) {
+                delay = left > 0 ? (int)(left * 1000) : 0;  // No input will come
+            }
+            usleep(delay * 1000);
+        }
+        double elapsed = timeNow() - start;
+        double cpu = (double)(clock() - cpuStart) / CLOCKS_PER_SEC;
+        printf("  %7.1f  %6.1f%%", frames / elapsed, cpu / elapsed * 100);
+    }
+    printf("\n");
+}
+
+// Play for seconds of real time in one pacing mode, hz 0 meaning the old
+// 16 ms timer (sleep after each frame), and report the frame intervals
+static void pacingSession(PacingMode mode, int hz, double seconds) {
+    startSession(PLAYING);
+    FixedStep loop;
+    fixedStepInit(loop, SIM_DT, 0.25);
+    Pacing pacing;
+    pacingInit(pacing, PACING_IDLE_HZ);
+    pacingSetMode(pacing, mode, hz);
+    FrameStats* stats = (FrameStats*)malloc(sizeof(FrameStats));
+    frameStatsReset(*stats);
+
+    double maxLate = 0, totalLate = 0;
+    long frames = 0;
+    double start = timeNow(), last = start;
+    clock_t cpuStart = clock();
+    while (timeNow() - start < seconds) {
+        double late = pacingWait(pacing);
+        totalLate += late;
+        maxLate = std::max(maxLate, late);
+        double now = timeNow();
+        int ticks = fixedStepAdvance(loop, now - last);
+        last = now;
+        for (int i = 0; i < ticks; i++) {
+            stepSession(true);
+            if (currentState != PLAYING) {
+                resetGame();
+                currentState = PLAYING;
+            }
+        }
+        sceneRender((int)((now - start) * 1000), fixedStepAlpha(loop));
+        glFinish();  // The swap
+        frameStatsAdd(*stats, timeNow());
+        frames++;
+        if (mode == PACING_TIMER) {
+            usleep(PACING_ACTIVE_MS * 1000);
+        }
+    }
+    double elapsed = timeNow() - start;
+    double cpu = (double)(clock() - cpuStart) / CLOCKS_PER_SEC;
+
+    FrameSummary summary = frameStatsSummary(*stats);
+    char name[32];
+    if (mode == PACING_TIMER) {
+        snprintf(name, sizeof(name), "timer %d ms", PACING_ACTIVE_MS);
+    } else if (mode == PACING_FIXED) {
+        snprintf(name, sizeof(name), "fixed %d Hz", hz);
+    } else {
+        snprintf(name, sizeof(name), "uncapped");
+    }
+    printf("%-13s %7.1f  %8.3f  %7.3f  %7.3f  %7.3f  %8.1f  %8.1f  %6ld  %5.1f%%\n", name,
+           frames / elapsed, summary.mean * 1000, summary.jitter * 1000, summary.p99 * 1000,
+           summary.max * 1000, totalLate / frames * 1e6, maxLate * 1e6, pacing.missed,
+           cpu / elapsed * 100);
+    free(stats);
+}
+
+int main(int argc, char** argv) {
+    bool fixedFunction = argc > 1 && strcmp(argv[1], "--fixed-function") == 0;
+    if (fixedFunction) {
+        argv[1] = argv[0];
+        argv++;
+        argc--;
+    }
+    if (!offscreenInit(WINDOW_WIDTH, WINDOW_HEIGHT)) {
+        return 1;
+    }
+    glClear(GL_COLOR_BUFFER_BIT);
+    textAtlasBuild(offscreenDrawGlyph, offscreenGlyphAdvance);
+    if (!fixedFunction) {
+        batchEffectsInit();
+    }
+    sceneInit(SESSION_SEED);
+
+    int result = 0;
+    if (argc > 1 && (strcmp(argv[1], "--check") == 0 || strcmp(argv[1], "--update") == 0)) {
+        const char* dir = argc > 2 ? argv[2] : "golden";
+        bool update = strcmp(argv[1], "--update") == 0;
+        if (batchEffectsActive()) {
+            printf("shader effects (%s)\n", dir);
+            result = checkGolden(dir, update);
+        } else if (!fixedFunction) {
+            printf("no shader effects, checking the fixed-function path only\n");
+        }
+        // Then the fallback, with the cached layers drawn again without effects
+        char fixedDir[512];
+        snprintf(fixedDir, sizeof(fixedDir), "%s/fixed", dir);
+        batchEffectsEnable(false);
+        sceneFreeLayers();
+        printf("fixed function (%s)\n", fixedDir);
+        result |= checkGolden(fixedDir, update);
+    } else if (argc > 1 && strcmp(argv[1], "--idle") == 0) {
+        double seconds = argc > 2 ? atof(argv[2]) : 5;
+        int idleFps = argc > 3 ? atoi(argv[3]) : PACING_IDLE_HZ;
+        printf("renderer: %s%s\n", offscreenRenderer(), batchEffectsActive() ? ", shader effects" : "");
+        printf("              every %d ms        paced (idle %d fps)\n", PACING_ACTIVE_MS, idleFps);
+        printf("session         fps     CPU       fps     CPU\n");
+        idleSession("menu", MENU, seconds, idleFps);
+        idleSession("instructions", INSTRUCTIONS, seconds, idleFps);
+        idleSession("playing", PLAYING, seconds, idleFps);
+        idleSession("game_over", GAME_OVER, seconds, idleFps);
+    } else if (argc > 1 && strcmp(argv[1], "--pacing") == 0) {
+        double seconds = argc > 2 ? atof(argv[2]) : 5;
+        printf("renderer: %s%s\n", offscreenRenderer(), batchEffectsActive() ? ", shader effects" : "");
+        printf("mode              fps  mean ms  jitter   p99 ms   max ms  late us  max late  missed    CPU\n");
+        pacingSession(PACING_TIMER, 0, seconds);
+        const int rates[] = {60, 120, 144, 240};
+        for (int i = 0; i < 4; i++) {
+            pacingSession(PACING_FIXED, rates[i], seconds);
+        }
+        pacingSession(PACING_UNCAPPED, 0, seconds);
+    } else if (argc > 1 && strcmp(argv[1], "--ghosts") == 0) {
+        int count = argc > 2 ? atoi(argv[2]) : 10000;
+        int frames = argc > 3 ? atoi(argv[3]) : 300;
+        if (frames < 1) frames = 1;
+        printf("renderer: %s%s\n", offscreenRenderer(), batchEffectsActive() ? ", shader effects" : "");
+        printf("ghosts        frames   avg ms   p50 ms   p95 ms   max ms  GL calls  draws  vertices\n");
+        for (int n = 10; ; n *= 10) {
+            sessionGhosts = n < count ? n : count;
+            char name[32];
+            snprintf(name, sizeof(name), "%d", sessionGhosts);
+            benchSession(name, PLAYING, frames);
+            if (n >= count) break;
+        }
+        sessionGhosts = 0;
+    } else {
+        int frames = argc > 1 ? atoi(argv[1]) : 300;
+        if (frames < 1) frames = 1;
+        printf("renderer: %s%s\n", offscreenRenderer(), batchEffectsActive() ? ", shader effects" : "");
+        printf("session       frames   avg ms   p50 ms   p95 ms   max ms  GL calls  draws  vertices\n");
+        benchSession("menu", MENU, frames);
+        benchSession("instructions", INSTRUCTIONS, frames);
+        benchSession("playing", PLAYING, frames);
+        benchSession("game_over", GAME_OVER, frames);
+    }
+
+    textAtlasFree();
+    sceneFreeLayers();
+    sceneStopRace();
+    particlesFree(particles);
+    offscreenShutdown();
+    return result;
+}
@@ -0,0 +1,204 @@
+#include "flappy_ghost.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char ghostMagic[4] = {'F', 'B', 'G', 'H'};
+
+void ghostInit(GhostSet& set, unsigned int seed) {
+    memset(&set, 0, sizeof(set));
+    set.seed = seed;
+    set.pipeCount = MAX_PIPES;
+    set.pipeSpacing = PIPE_SPACING;
+    set.sweptCollision = false;
+}
+
+void ghostFree(GhostSet& set) {
+    free(set.runStart);
+    free(set.runLength);
+    free(set.heights);
+    memset(&set, 0, sizeof(set));
+}
+
+void ghostBeginRun(GhostSet& set) {
+    if (set.open) {
+        set.runCount--;
+        set.heightCount = set.runStart[set.runCount];
+        set.open = false;
+    }
+    if (set.runCount == set.runCapacity) {
+        int capacity = set.runCapacity ? set.runCapacity * 2 : 64;
+        int* start = (int*)realloc(set.runStart, capacity * sizeof(int));
+        if (start) set.runStart = start;
+        int* length = (int*)realloc(set.runLength, capacity * sizeof(int));
+        if (length) set.runLength = length;
+        if (!start || !length) {
+            return;
+        }
+        set.runCapacity = capacity;
+    }
+    set.runStart[set.runCount] = set.heightCount;
+    set.runLength[set.runCount] = 0;
+    set.runCount++;
+    set.open = true;
+}
+
+void ghostAddTick(GhostSet& set, float birdY) {
+    if (!set.open || set.runLength[set.runCount - 1] >= GHOST_MAX_TICKS) {
+        return;
+    }
+    if (set.heightCount == set.heightCapacity) {
+        int capacity = set.heightCapacity ? set.heightCapacity * 2 : 4096;
+        short* heights = (short*)realloc(set.heights, capacity * sizeof(short));
+        if (!heights) {
+            return;
+        }
+        set.heights = heights;
+        set.heightCapacity = capacity;
+    }
+    float scaled = birdY * GHOST_Y_SCALE;
+    if (scaled > 32767) scaled = 32767;
+    if (scaled < -32768) scaled = -32768;
+    set.heights[set.heightCount++] = (short)(scaled < 0 ? scaled - 0.5f : scaled + 0.5f);
+    set.runLength[set.runCount - 1]++;
+}
+
+void ghostEndRun(GhostSet& set) {
+    set.open = false;
+}
+
+// Scripted bot: flap when falling below the next gap's centre plus aim,
+// jittered a little on every tick
+static bool botWantsFlap(const SimState& state, int aim, Random& rng) {
+    const Pipe* next = simNextPipe(state);
+    float targetY = next ? next->gapY + aim + randomRange(rng, 9) - 4 : WINDOW_HEIGHT / 2;
+    return state.birdY > targetY && state.birdVelocity >= 0;
+}
+
+long ghostRecordBots(GhostSet& set, int count, unsigned int variation, const LevelFile* level) {
+    Random rng;
+    randomSeed(rng, variation, RANDOM_STREAM_GHOSTS);
+    SimState state;
+    simInit(state, set.seed);
+    simSetLevel(state, set.pipeCount, set.pipeSpacing);
+    simSetLevelFile(state, set.levelChecksum != 0 ? level : NULL);
+    simSetSweptCollision(state, set.sweptCollision);
+
+    long ticks = 0;
+    for (int r = 0; r < count; r++) {
+        simRestart(state, set.seed);
+        int aim = randomRange(rng, 51) - 15;
+        ghostBeginRun(set);
+        ghostAddTick(set, state.birdY);
+        while (!state.dead && (int)state.tick < GHOST_MAX_TICKS - 1) {
+            SimInput input = { botWantsFlap(state, aim, rng) };
+            simStep(state, input);
+            ghostAddTick(set, state.birdY);
+        }
+        ghostEndRun(set);
+        ticks += state.tick + 1;
+    }
+    return ticks;
+}
+
+static void writeWord(FILE* f, unsigned int value) {
+    unsigned char bytes[4] = {(unsigned char)value, (unsigned char)(value >> 8),
+                              (unsigned char)(value >> 16), (unsigned char)(value >> 24)};
+    fwrite(bytes, 1, 4, f);
+}
+
+static bool readWord(FILE* f, unsigned int& value) {
+    unsigned char bytes[4];
+    if (fread(bytes, 1, 4, f) != 4) {
+        return false;
+    }
+    value = bytes[0] | bytes[1] << 8 | bytes[2] << 16 | (unsigned int)bytes[3] << 24;
+    return true;
+}
+
+bool ghostSave(const GhostSet& set, const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        return false;
+    }
+    int runs = ghostFinishedRuns(set);
+    fwrite(ghostMagic, 1, sizeof(ghostMagic), f);
+    fputc(GHOST_VERSION, f);
+    writeWord(f, set.seed);
+    writeWord(f, set.pipeCount);
+    writeWord(f, set.pipeSpacing);
+    writeWord(f, set.sweptCollision ? 1 : 0);
+    writeWord(f, set.levelChecksum);
+    writeWord(f, runs);
+    for (int r = 0; r < runs; r++) {
+        writeWord(f, set.runLength[r]);
+    }
+    // Runs are packed in order, so the finished ones are one block
+    int count = runs > 0 ? set.runStart[runs - 1] + set.runLength[runs - 1] : 0;
+    for (int i = 0; i < count; i++) {
+        unsigned short h = (unsigned short)set.heights[i];
+        unsigned char bytes[2] = {(unsigned char)h, (unsigned char)(h >> 8)};
+        fwrite(bytes, 1, 2, f);
+    }
+    bool ok = !ferror(f);
+    if (fclose(f) != 0) {
+        ok = false;
+    }
+    return ok;
+}
+
+bool ghostLoad(GhostSet& set, const char* path) {
+    ghostInit(set, 0);
+
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return false;
+    }
+    char magic[4];
+    unsigned int pipeCount = 0, pipeSpacing = 0, swept = 0, runs = 0;
+    bool ok = fread(magic, 1, 4, f) == 4 && memcmp(magic, ghostMagic, 4) == 0 &&
+              fgetc(f) == GHOST_VERSION &&
+              readWord(f, set.seed) && readWord(f, pipeCount) && readWord(f, pipeSpacing) &&
+              readWord(f, swept) && readWord(f, set.levelChecksum) && readWord(f, runs) &&
+              pipeCount >= 1 && pipeCount <= SIM_PIPE_CAPACITY &&
+              pipeSpacing >= 1 && pipeSpacing <= SIM_MAX_PIPE_SPACING && swept <= 1 &&
+              runs <= (1u << 24);
+    set.pipeCount = (int)pipeCount;
+    set.pipeSpacing = (int)pipeSpacing;
+    set.sweptCollision = swept != 0;
+
+    long total = 0;
+    if (ok) {
+        set.runStart = (int*)malloc((runs > 0 ? runs : 1) * sizeof(int));
+        set.runLength = (int*)malloc((runs > 0 ? runs : 1) * sizeof(int));
+        set.runCapacity = set.runStart && set.runLength ? (int)runs : 0;
+        ok = set.runCapacity == (int)runs;
+    }
+    for (unsigned int r = 0; ok && r < runs; r++) {
+        unsigned int length = 0;
+        ok = readWord(f, length) && length <= GHOST_MAX_TICKS;
+        set.runStart[r] = (int)total;
+        set.runLength[r] = (int)length;
+        total += length;
+    }
+    if (ok) {
+        set.runCount = (int)runs;
+        set.heights = (short*)malloc((total > 0 ? total : 1) * sizeof(short));
+        ok = set.heights && total <= 0x7fffffff &&
+             fread(set.heights, sizeof(short), total, f) == (size_t)total &&
+             fgetc(f) == EOF;
+    }
+    fclose(f);
+
+    if (ok) {
+        // Stored little-endian
+        unsigned char* bytes = (unsigned char*)set.heights;
+        for (long i = 0; i < total; i++) {
+            set.heights[i] = (short)(bytes[2 * i] | bytes[2 * i + 1] << 8);
+        }
+        set.heightCount = set.heightCapacity = (int)total;
+    } else {
+        ghostFree(set);
+    }
+    return ok;
+}
@@ -0,0 +1,71 @@
+// Ghost runs
+// Previous runs of one level, kept as the bird's height on every tick so
+// they can fly alongside the live bird without stepping the simulation
+// again. Heights are 16-bit fixed point (GHOST_Y_SCALE steps per pixel),
+// two bytes per tick, packed run after run in one array. Every run of a
+// set was played from the same seed, level shape and level file, so the
+// pipes line up with a live run started from them.
+//
+// File layout: "FBGH", version byte, then little-endian 32-bit values:
+// seed, pipe count, pipe spacing, swept collision (0 or 1), level file
+// checksum (0 for none), run count, each run's tick count; then the
+// heights of every run, 16 bits each.
+#ifndef FLAPPY_GHOST_H
+#define FLAPPY_GHOST_H
+
+#include "flappy_sim.h"
+#include "flappy_level.h"
+
+#define GHOST_VERSION 2
+#define GHOST_Y_SCALE 8          // Height steps per pixel
+#define GHOST_MAX_TICKS 60000    // Longest run kept (16 minutes)
+
+struct GhostSet {
+    unsigned int seed;       // simRestart() seed of every run
+    int pipeCount;           // Level shape, see simSetLevel()
+    int pipeSpacing;
+    bool sweptCollision;     // simSetSweptCollision()
+    unsigned int levelChecksum;  // Level file's data checksum, 0 for none
+    int runCount;            // Finished runs, then the open one if any
+    int runCapacity;
+    int* runStart;           // Index of each run's first height
+    int* runLength;          // Ticks in each run
+    short* heights;
+    int heightCount;
+    int heightCapacity;
+    bool open;               // The last run is still being recorded
+};
+
+// Empty set of the default level; set the level fields before recording
+void ghostInit(GhostSet& set, unsigned int seed);
+void ghostFree(GhostSet& set);
+
+// Start recording a run, dropping a run left open; ghostAddTick() then
+// records the bird height at ticks 0, 1, 2... and ghostEndRun() keeps it
+void ghostBeginRun(GhostSet& set);
+void ghostAddTick(GhostSet& set, float birdY);
+void ghostEndRun(GhostSet& set);
+
+// Finished runs, i.e. the ones to draw
+static inline int ghostFinishedRuns(const GhostSet& set) {
+    return set.open ? set.runCount - 1 : set.runCount;
+}
+
+// Bird height of a run at a tick before its length
+static inline float ghostHeight(const GhostSet& set, int run, int tick) {
+    return set.heights[set.runStart[run] + tick] * (1.0f / GHOST_Y_SCALE);
+}
+
+// Record count runs of a scripted bot from the set's level, each with its
+// own aim (from variation) so they spread out and end in different ways;
+// for demos and benchmarks. A set of a level file is recorded on level,
+// which must be that file. Returns the ticks recorded.
+long ghostRecordBots(GhostSet& set, int count, unsigned int variation, const LevelFile* level);
+
+bool ghostSave(const GhostSet& set, const char* path);
+
+// Read a ghost file into set (initialized or not); false if the file is
+// missing, truncated or not a ghost file
+bool ghostLoad(GhostSet& set, const char* path);
+
+#endif
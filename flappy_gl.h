@@ -0,0 +1,16 @@
+// OpenGL headers for the platforms we build on
+#ifndef FLAPPY_GL_H
+#define FLAPPY_GL_H
+
+#ifdef __APPLE__
+#include <OpenGL/gl.h>
+#include <OpenGL/glext.h>
+#include <OpenGL/glu.h>
+#else
+// Entry points past GL 1.3 (glBlendFuncSeparate, framebuffer objects)
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glu.h>
+#endif
+
+#endif
@@ -0,0 +1,100 @@
+#include "flappy_layer.h"
+#include "flappy_render.h"
+#include <string.h>
+#include <math.h>
+
+bool layerSupported() {
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    return extensions && strstr(extensions, "GL_EXT_framebuffer_object") != NULL;
+}
+
+bool layerBuild(Layer& layer, int width, int height, void (*draw)()) {
+    if (!layerSupported()) {
+        return false;
+    }
+    batchFlush();
+    // Errors from earlier calls are not this build's
+    while (glGetError() != GL_NO_ERROR) {
+    }
+
+    if (layer.texture == 0) {
+        glGenTextures(1, &layer.texture);
+    }
+    layer.width = width;
+    layer.height = height;
+    glBindTexture(GL_TEXTURE_2D, layer.texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    GLint previous;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING_EXT, &previous);
+    GLuint framebuffer;
+    glGenFramebuffersEXT(1, &framebuffer);
+    glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, framebuffer);
+    glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D,
+                              layer.texture, 0);
+    bool ok = glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT) == GL_FRAMEBUFFER_COMPLETE_EXT;
+
+    if (ok) {
+        // Texture coordinates, y down like the screen, on a transparent
+        // background
+        GLint viewport[4];
+        GLfloat clearColor[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+        glViewport(0, 0, width, height);
+        glMatrixMode(GL_PROJECTION);
+        glPushMatrix();
+        glLoadIdentity();
+        glOrtho(0, width, height, 0, -1, 1);
+        glMatrixMode(GL_MODELVIEW);
+        glPushMatrix();
+        glLoadIdentity();
+
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        draw();
+        batchFlush();
+
+        glPopMatrix();
+        glMatrixMode(GL_PROJECTION);
+        glPopMatrix();
+        glMatrixMode(GL_MODELVIEW);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+    }
+
+    glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, previous);
+    glDeleteFramebuffersEXT(1, &framebuffer);
+    if (glGetError() != GL_NO_ERROR) {
+        ok = false;
+    }
+    if (!ok) {
+        layerFree(layer);
+    }
+    return ok;
+}
+
+void layerFree(Layer& layer) {
+    if (layer.texture != 0) {
+        glDeleteTextures(1, &layer.texture);
+        layer.texture = 0;
+    }
+}
+
+void batchLayer(const Layer& layer, int bandY, int bandHeight, float offset, float y,
+                float screenWidth) {
+    if (layer.texture == 0) {
+        return;
+    }
+    // Rows were drawn top-down, so row r is at v = 1 - r / height
+    float shift = floor(offset + 0.5f) / layer.width;
+    batchTexturedQuad(layer.texture, 0, y, screenWidth, y + bandHeight,
+                      -shift, 1 - (float)bandY / layer.height,
+                      screenWidth / layer.width - shift,
+                      1 - (float)(bandY + bandHeight) / layer.height);
+}
@@ -0,0 +1,39 @@
+// Cached layers
+// A band of the scene that only ever slides sideways (the clouds) is drawn
+// once into a texture through a framebuffer object, then added to the batch
+// each frame as one textured quad, scrolled and wrapped with GL_REPEAT and
+// tinted by the current color. Drawing it costs the same whatever is in it.
+// The texture is sampled 1:1 at whole-pixel offsets with nearest filtering,
+// so the band looks as if its geometry had been drawn directly.
+#ifndef FLAPPY_LAYER_H
+#define FLAPPY_LAYER_H
+
+#include "flappy_gl.h"
+
+struct Layer {
+    GLuint texture;  // 0 until built
+    int width;
+    int height;
+};
+
+// Whether the current context can render to textures
+// (EXT_framebuffer_object)
+bool layerSupported();
+
+// Draw a width x height image into layer's texture. draw() records it
+// into the batch in texture coordinates: x from 0 to width, y down from the
+// top edge. Several bands can share one texture, stacked vertically, so
+// they draw as one run. width must be a power of two so bands can wrap.
+// Anything already in the batch is flushed first. Returns false, leaving
+// the texture 0, if render-to-texture is not supported or the build raised
+// a GL error.
+bool layerBuild(Layer& layer, int width, int height, void (*draw)());
+void layerFree(Layer& layer);
+
+// Add the band of rows bandY to bandY + bandHeight to the batch across the
+// screen from x = 0 to screenWidth, its top edge at y, moved right by
+// offset pixels (rounded) and repeated every width pixels
+void batchLayer(const Layer& layer, int bandY, int bandHeight, float offset, float y,
+                float screenWidth);
+
+#endif
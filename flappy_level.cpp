@@ -0,0 +1,166 @@
+#include "flappy_level.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const char levelMagic[4] = {'F', 'B', 'L', 'V'};
+
+unsigned int levelChecksum(const void* data, size_t size, unsigned int hash) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static unsigned int headerChecksum(const LevelHeader& header) {
+    return levelChecksum(&header, offsetof(LevelHeader, headerChecksum), LEVEL_CHECKSUM_START);
+}
+
+bool levelOpen(LevelFile& level, const char* path) {
+    memset(&level, 0, sizeof(level));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(LevelHeader)) {
+        close(fd);
+        return false;
+    }
+    size_t size = (size_t)info.st_size;
+    void* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // The mapping keeps the file
+    if (map == MAP_FAILED) {
+        return false;
+    }
+
+    const LevelHeader* header = (const LevelHeader*)map;
+    bool ok = memcmp(header->magic, levelMagic, sizeof(levelMagic)) == 0 &&
+              header->version == LEVEL_VERSION && header->byteOrder == LEVEL_BYTE_ORDER &&
+              header->headerChecksum == headerChecksum(*header) &&
+              header->window >= 1 && header->window <= SIM_PIPE_CAPACITY &&
+              (size - sizeof(LevelHeader)) / sizeof(LevelPipe) == header->pipeCount &&
+              (size - sizeof(LevelHeader)) % sizeof(LevelPipe) == 0;
+    if (!ok) {
+        munmap(map, size);
+        return false;
+    }
+    // Pipes are read once, front to back, as the level scrolls
+    madvise(map, size, MADV_SEQUENTIAL);
+    level.header = header;
+    level.pipes = (const LevelPipe*)(header + 1);
+    level.pipeCount = header->pipeCount;
+    level.map = map;
+    level.mapSize = size;
+    return true;
+}
+
+void levelClose(LevelFile& level) {
+    if (level.map) {
+        munmap(level.map, level.mapSize);
+    }
+    memset(&level, 0, sizeof(level));
+}
+
+// Whether every field of a record is in its range
+static bool pipeInRange(const LevelPipe& pipe) {
+    return pipe.spacing >= 1 && pipe.spacing <= SIM_MAX_PIPE_SPACING &&
+           pipe.gapY <= WINDOW_HEIGHT && pipe.gap <= WINDOW_HEIGHT && pipe.reserved == 0;
+}
+
+// Smallest spacing between pipes on screen together; the first pipe's
+// spacing only counts when a looping level wraps around
+static unsigned int minimumSpacing(unsigned int minSpacing, const LevelPipe& pipe, bool counts) {
+    return counts && pipe.spacing < minSpacing ? pipe.spacing : minSpacing;
+}
+
+bool levelVerify(const LevelFile& level) {
+    if (levelChecksum(level.pipes, (size_t)level.pipeCount * sizeof(LevelPipe),
+                      LEVEL_CHECKSUM_START) != level.header->dataChecksum) {
+        return false;
+    }
+    bool loop = (level.header->flags & LEVEL_LOOP) != 0;
+    unsigned int minSpacing = SIM_MAX_PIPE_SPACING;
+    for (unsigned int i = 0; i < level.pipeCount; i++) {
+        if (!pipeInRange(level.pipes[i])) {
+            return false;
+        }
+        minSpacing = minimumSpacing(minSpacing, level.pipes[i], i > 0 || loop);
+    }
+    return (int)level.header->window >= simPipesToFill(minSpacing);
+}
+
+void simSetLevelFile(SimState& state, const LevelFile* level) {
+    if (level && level->pipeCount > 0) {
+        state.levelRecords = level->pipes;
+        state.levelLength = level->pipeCount;
+        state.levelLoop = (level->header->flags & LEVEL_LOOP) != 0;
+        state.levelWindow = (int)level->header->window;
+    } else {
+        state.levelRecords = NULL;
+        state.levelLength = 0;
+        state.levelLoop = false;
+        state.levelWindow = 0;
+    }
+    // The level's window only while it is attached
+    state.pipeCount = state.basePipeCount > state.levelWindow ? state.basePipeCount
+                                                              : state.levelWindow;
+}
+
+bool levelWriterOpen(LevelWriter& writer, const char* path, unsigned int flags) {
+    memset(&writer, 0, sizeof(writer));
+    memcpy(writer.header.magic, levelMagic, sizeof(levelMagic));
+    writer.header.version = LEVEL_VERSION;
+    writer.header.byteOrder = LEVEL_BYTE_ORDER;
+    writer.header.flags = flags;
+    writer.header.dataChecksum = LEVEL_CHECKSUM_START;
+    writer.minSpacing = SIM_MAX_PIPE_SPACING;
+    writer.file = fopen(path, "wb");
+    // Room for the header, written on close
+    return writer.file && fwrite(&writer.header, sizeof(writer.header), 1, writer.file) == 1;
+}
+
+// Nearest value a 16-bit field holds, in range or not
+static unsigned short toField(float value) {
+    return value < 0 ? 0 : value > 65535 ? 65535 : (unsigned short)(value + 0.5f);
+}
+
+bool levelWriterAdd(LevelWriter& writer, float spacing, float gapY, float gap) {
+    LevelPipe pipe;
+    pipe.spacing = toField(spacing);
+    pipe.gapY = toField(gapY);
+    pipe.gap = gap == PIPE_GAP ? 0 : toField(gap);
+    pipe.reserved = 0;
+    if (!pipeInRange(pipe) || (gap != PIPE_GAP && pipe.gap == 0)) {
+        writer.failed = true;
+        return false;
+    }
+    bool counts = writer.header.pipeCount > 0 || (writer.header.flags & LEVEL_LOOP);
+    writer.minSpacing = minimumSpacing(writer.minSpacing, pipe, counts);
+    writer.header.dataChecksum = levelChecksum(&pipe, sizeof(pipe), writer.header.dataChecksum);
+    writer.header.pipeCount++;
+    if (writer.file) {
+        fwrite(&pipe, sizeof(pipe), 1, writer.file);
+    }
+    return true;
+}
+
+bool levelWriterClose(LevelWriter& writer) {
+    if (!writer.file) {
+        return false;
+    }
+    int window = simPipesToFill(writer.minSpacing);
+    writer.header.window = window < SIM_PIPE_CAPACITY ? window : SIM_PIPE_CAPACITY;
+    writer.header.headerChecksum = headerChecksum(writer.header);
+    bool ok = !writer.failed && !ferror(writer.file) && window <= SIM_PIPE_CAPACITY &&
+              fseek(writer.file, 0, SEEK_SET) == 0 &&
+              fwrite(&writer.header, sizeof(writer.header), 1, writer.file) == 1;
+    if (fclose(writer.file) != 0) {
+        ok = false;
+    }
+    writer.file = NULL;
+    return ok;
+}
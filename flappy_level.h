@@ -0,0 +1,92 @@
+// Level files
+// Precomputed pipe sequences of any length, for curated, tournament or
+// benchmark levels. A level file is memory-mapped and its records are read
+// in place as pipes scroll into the ring (simSetLevelFile()), so opening a
+// level of millions of pipes costs the same as one of ten, and only the
+// pages flown past are ever read from disk.
+//
+// File layout, read in place in the host's byte order (LEVEL_BYTE_ORDER
+// tells a foreign file apart): a LevelHeader, then pipeCount LevelPipe
+// records of 8 bytes. A record's spacing is its distance from the previous
+// pipe; the first pipe of a run starts at the right edge of the screen as
+// in the generated level, so the first record's spacing only counts when a
+// looping level wraps around. After the last record a LEVEL_LOOP level
+// starts over; any other continues with generated pipes.
+#ifndef FLAPPY_LEVEL_H
+#define FLAPPY_LEVEL_H
+
+#include "flappy_sim.h"
+#include <stdio.h>
+#include <stddef.h>
+
+#define LEVEL_VERSION 1
+#define LEVEL_BYTE_ORDER 0x01020304u
+#define LEVEL_LOOP 1  // Flag: start over after the last pipe
+
+struct LevelHeader {
+    char magic[4];                // "FBLV"
+    unsigned int version;
+    unsigned int byteOrder;       // LEVEL_BYTE_ORDER as written
+    unsigned int flags;
+    unsigned int pipeCount;       // Records
+    unsigned int window;          // Pipes alive to keep the screen filled
+    unsigned int dataChecksum;    // levelChecksum() of the records
+    unsigned int headerChecksum;  // levelChecksum() of the fields above
+};
+
+struct LevelPipe {
+    unsigned short spacing;   // From the previous pipe's left edge, 1 to SIM_MAX_PIPE_SPACING
+    unsigned short gapY;      // Gap centre, 0 to WINDOW_HEIGHT
+    unsigned short gap;       // Gap height up to WINDOW_HEIGHT, 0 for PIPE_GAP
+    unsigned short reserved;  // 0
+};
+
+// An open level: the header and records point into the mapping
+struct LevelFile {
+    const LevelHeader* header;
+    const LevelPipe* pipes;
+    unsigned int pipeCount;
+    void* map;
+    size_t mapSize;
+};
+
+// Level being written, one record at a time; the header goes in last
+struct LevelWriter {
+    FILE* file;
+    LevelHeader header;
+    unsigned int minSpacing;
+    bool failed;  // A pipe was out of range
+};
+
+// FNV-1a of size bytes, continuing from hash (start with
+// LEVEL_CHECKSUM_START)
+#define LEVEL_CHECKSUM_START 2166136261u
+unsigned int levelChecksum(const void* data, size_t size, unsigned int hash);
+
+// Map a level file; false if it is missing, truncated, from a machine of
+// the other byte order or its header does not check out. The records are
+// not read (see levelVerify()).
+bool levelOpen(LevelFile& level, const char* path);
+void levelClose(LevelFile& level);
+
+// Read every record: false unless they match the header's checksum, every
+// field is in its range (LevelPipe) and the header's window keeps the
+// closest pipes filled. The simulation reads records unchecked, so verify
+// a level before attaching it.
+bool levelVerify(const LevelFile& level);
+
+// Stream the level's pipes into state from its next reset, with at least
+// the level's window of pipes alive; NULL goes back to generated pipes and
+// the simSetLevel() pipe count. The level must have passed levelVerify()
+// and stay open while state, or any copy of it, is stepped.
+void simSetLevelFile(SimState& state, const LevelFile* level);
+
+// Write a level: open, add every pipe, close. Adding a pipe with a field
+// out of its range (LevelPipe) returns false and fails the close, as do
+// I/O errors and spacings that need more pipes alive than
+// SIM_PIPE_CAPACITY.
+bool levelWriterOpen(LevelWriter& writer, const char* path, unsigned int flags);
+bool levelWriterAdd(LevelWriter& writer, float spacing, float gapY, float gap);
+bool levelWriterClose(LevelWriter& writer);
+
+#endif
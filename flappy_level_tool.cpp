@@ -0,0 +1,246 @@
+// Level file tool
+// Writes, checks and benchmarks level files (flappy_level.h). --generate
+// writes count random pipes with spacings and gap sizes drawn from the
+// given ranges. --from-seed writes the first count pipes of a seed's
+// generated level and checks that a bot run on the file matches the run on
+// the generated level tick for tick. --bench times opening and verifying a
+// level and streaming its pipes through the ring, against generated pipes.
+//
+// Usage: flappy_level_tool --generate FILE count [seed] [--loop]
+//                          [--spacing MIN MAX] [--gap MIN MAX]
+//        flappy_level_tool --from-seed FILE count seed
+//        flappy_level_tool --info FILE
+//        flappy_level_tool --verify FILE
+//        flappy_level_tool --bench FILE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "flappy_sim.h"
+#include "flappy_level.h"
+#include "flappy_random.h"
+#include "flappy_time.h"
+
+// Scripted bot: flap when falling below the centre of the next gap
+static bool botWantsFlap(const SimState& state) {
+    const Pipe* next = simNextPipe(state);
+    float targetY = next ? next->gapY + 10 : WINDOW_HEIGHT / 2;
+    return state.birdY > targetY && state.birdVelocity >= 0;
+}
+
+// Value in [low, high] from the level stream
+static int randomBetween(Random& rng, int low, int high) {
+    return high > low ? low + randomRange(rng, high - low + 1) : low;
+}
+
+static int generate(const char* path, long count, unsigned int seed, unsigned int flags,
+                    int minSpacing, int maxSpacing, int minGap, int maxGap) {
+    Random rng;
+    randomSeed(rng, seed, RANDOM_STREAM_LEVEL);
+    LevelWriter writer;
+    levelWriterOpen(writer, path, flags);
+    double start = timeNow();
+    bool inRange = true;
+    for (long i = 0; i < count && inRange; i++) {
+        float spacing = (float)randomBetween(rng, minSpacing, maxSpacing);
+        float gap = (float)randomBetween(rng, minGap, maxGap);
+        inRange = levelWriterAdd(writer, spacing, simRandomGapY(rng), gap);
+    }
+    if (!levelWriterClose(writer)) {
+        if (!inRange) {
+            fprintf(stderr, "cannot write %s: spacing or gap out of range\n", path);
+        } else if (simPipesToFill(writer.minSpacing) > SIM_PIPE_CAPACITY) {
+            fprintf(stderr, "cannot write %s: spacings below %d need more than %d pipes alive\n",
+                    path, (WINDOW_WIDTH + PIPE_WIDTH) / (SIM_PIPE_CAPACITY - 1) + 1,
+                    SIM_PIPE_CAPACITY);
+        } else {
+            fprintf(stderr, "cannot write %s\n", path);
+        }
+        return 1;
+    }
+    double megabytes = (sizeof(LevelHeader) + count * sizeof(LevelPipe)) / (1024.0 * 1024.0);
+    printf("wrote %ld pipes (%.1f MB, window %u) to %s in %.2f s\n", count, megabytes,
+           writer.header.window, path, timeNow() - start);
+    return 0;
+}
+
+// Step a bot through state until it dies or passes count pipes, then
+// through a copy running on level; false at the first tick they differ
+static bool sameRun(const SimState& generated, const LevelFile& level, long count, long& ticks) {
+    SimState a = generated;
+    SimState b = generated;
+    simSetLevelFile(b, &level);
+    simReset(b);
+    ticks = 0;
+    while (!a.dead && a.score < count) {
+        SimInput input = { botWantsFlap(a) };
+        simStep(a, input);
+        simStep(b, input);
+        ticks++;
+        if (a.birdY != b.birdY || a.score != b.score || a.dead != b.dead) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int fromSeed(const char* path, long count, unsigned int seed) {
+    // The generated level draws every gap from the level stream, one pipe
+    // spacing apart
+    Random rng;
+    randomSeed(rng, seed, RANDOM_STREAM_LEVEL);
+    LevelWriter writer;
+    levelWriterOpen(writer, path, 0);
+    for (long i = 0; i < count; i++) {
+        levelWriterAdd(writer, PIPE_SPACING, simRandomGapY(rng), PIPE_GAP);
+    }
+    if (!levelWriterClose(writer)) {
+        fprintf(stderr, "cannot write %s\n", path);
+        return 1;
+    }
+    LevelFile level;
+    if (!levelOpen(level, path) || !levelVerify(level)) {
+        fprintf(stderr, "cannot read %s\n", path);
+        return 1;
+    }
+    SimState state;
+    simInit(state, seed);
+    long ticks;
+    bool same = sameRun(state, level, count, ticks);
+    printf("wrote %ld pipes of seed %u to %s; bot run %s the generated level (%ld ticks)\n",
+           count, seed, path, same ? "matches" : "DIFFERS from", ticks);
+    levelClose(level);
+    return same ? 0 : 1;
+}
+
+static int info(const char* path) {
+    LevelFile level;
+    if (!levelOpen(level, path)) {
+        printf("%s: not a level file\n", path);
+        return 1;
+    }
+    const LevelHeader& header = *level.header;
+    printf("%s: version %u, %u pipes%s, window %u, checksum %08x\n", path, header.version,
+           header.pipeCount, header.flags & LEVEL_LOOP ? " (loop)" : "", header.window,
+           header.dataChecksum);
+    levelClose(level);
+    return 0;
+}
+
+static int verify(const char* path) {
+    LevelFile level;
+    if (!levelOpen(level, path)) {
+        printf("%s: not a level file\n", path);
+        return 1;
+    }
+    double start = timeNow();
+    bool ok = levelVerify(level);
+    double elapsed = timeNow() - start;
+    printf("%s: %s (%u pipes in %.1f ms, %.0f MB/s)\n", path,
+           ok ? "ok" : "FAILED (checksum, range or window)", level.pipeCount, elapsed * 1000,
+           level.mapSize / (1024.0 * 1024.0) / (elapsed > 0 ? elapsed : 1e-9));
+    levelClose(level);
+    return ok ? 0 : 1;
+}
+
+// Scroll state's level a screen at a time until count pipes have come in;
+// returns the seconds taken. The ring holds more than a screen of pipes,
+// so no screen recycles all of them.
+static double stream(SimState& state, long count) {
+    long pipes = 0;
+    double start = timeNow();
+    while (pipes < count) {
+        int head = state.pipeHead;
+        state.scroll += WINDOW_WIDTH;
+        simRecyclePipes(state);
+        if (state.scroll >= SIM_SCROLL_REBASE) {
+            state.scroll -= SIM_SCROLL_REBASE;
+            for (int i = 0; i < state.pipeCount; i++) {
+                state.pipes[i].x -= SIM_SCROLL_REBASE;
+            }
+        }
+        pipes += (state.pipeHead - head + state.pipeCount) % state.pipeCount;
+    }
+    return timeNow() - start;
+}
+
+static int bench(const char* path) {
+    double start = timeNow();
+    LevelFile level;
+    if (!levelOpen(level, path)) {
+        printf("%s: not a level file\n", path);
+        return 1;
+    }
+    double opened = timeNow() - start;
+    printf("open:       %u pipes (%.1f MB) mapped in %.3f ms\n", level.pipeCount,
+           level.mapSize / (1024.0 * 1024.0), opened * 1000);
+    start = timeNow();
+    if (!levelVerify(level)) {
+        printf("%s: fails verification\n", path);
+        levelClose(level);
+        return 1;
+    }
+    printf("verify:     %u pipes read in %.1f ms\n", level.pipeCount, (timeNow() - start) * 1000);
+
+    // Verifying faulted the pages in, so this reads mapped memory
+    SimState state;
+    simInit(state, 1);
+    simSetLevelFile(state, &level);
+    simReset(state);
+    long count = level.pipeCount;
+    double elapsed = stream(state, count);
+    printf("level file: %ld pipes streamed in %.1f ms (%.1f M pipes/s)\n", count, elapsed * 1000,
+           count / elapsed / 1e6);
+
+    SimState generated;
+    simInit(generated, 1);
+    simSetLevel(generated, state.pipeCount, PIPE_SPACING);
+    simReset(generated);
+    elapsed = stream(generated, count);
+    printf("generated:  %ld pipes streamed in %.1f ms (%.1f M pipes/s)\n", count, elapsed * 1000,
+           count / elapsed / 1e6);
+    levelClose(level);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 3 && strcmp(argv[1], "--generate") == 0) {
+        long count = atol(argv[3]);
+        unsigned int seed = 1;
+        unsigned int flags = 0;
+        int minSpacing = PIPE_SPACING, maxSpacing = PIPE_SPACING;
+        int minGap = PIPE_GAP, maxGap = PIPE_GAP;
+        for (int i = 4; i < argc; i++) {
+            if (strcmp(argv[i], "--loop") == 0) {
+                flags |= LEVEL_LOOP;
+            } else if (strcmp(argv[i], "--spacing") == 0 && i + 2 < argc) {
+                minSpacing = atoi(argv[++i]);
+                maxSpacing = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--gap") == 0 && i + 2 < argc) {
+                minGap = atoi(argv[++i]);
+                maxGap = atoi(argv[++i]);
+            } else {
+                seed = strtoul(argv[i], NULL, 10);
+            }
+        }
+        return generate(argv[2], count, seed, flags, minSpacing, maxSpacing, minGap, maxGap);
+    }
+    if (argc > 4 && strcmp(argv[1], "--from-seed") == 0) {
+        return fromSeed(argv[2], atol(argv[3]), strtoul(argv[4], NULL, 10));
+    }
+    if (argc > 2 && strcmp(argv[1], "--info") == 0) {
+        return info(argv[2]);
+    }
+    if (argc > 2 && strcmp(argv[1], "--verify") == 0) {
+        return verify(argv[2]);
+    }
+    if (argc > 2 && strcmp(argv[1], "--bench") == 0) {
+        return bench(argv[2]);
+    }
+    printf("usage: flappy_level_tool --generate FILE count [seed] [--loop]\n"
+           "                         [--spacing MIN MAX] [--gap MIN MAX]\n"
+           "       flappy_level_tool --from-seed FILE count seed\n"
+           "       flappy_level_tool --info FILE\n"
+           "       flappy_level_tool --verify FILE\n"
+           "       flappy_level_tool --bench FILE\n");
+    return 1;
+}
@@ -0,0 +1,83 @@
+#include "flappy_lookahead.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+bool lookaheadInit(Lookahead& search, int beamWidth, int depth) {
+    search.beamWidth = beamWidth > 0 ? beamWidth : 1;
+    search.depth = depth > 0 ? depth : 1;
+    search.pool = (LookaheadNode*)malloc(3 * (size_t)search.beamWidth * sizeof(LookaheadNode));
+    search.nodesExpanded = 0;
+    search.decisions = 0;
+    return search.pool != NULL;
+}
+
+void lookaheadFree(Lookahead& search) {
+    free(search.pool);
+    memset(&search, 0, sizeof(search));
+}
+
+// Pipes passed count most; otherwise stay near the centre of the next gap
+static float evaluate(const SimSnapshot& s) {
+    const float birdX = WINDOW_WIDTH / 4;
+    float targetY = WINDOW_HEIGHT / 2;
+    for (int k = 0; k < s.pipeCount; k++) {
+        int i = s.pipeHead + k < s.pipeCount ? s.pipeHead + k : s.pipeHead + k - s.pipeCount;
+        if (s.pipeX[i] + PIPE_WIDTH >= birdX - BIRD_SIZE) {
+            targetY = s.pipeGapY[i];  // Pipes are in order from the head
+            break;
+        }
+    }
+    return s.score * 1000.0f - fabsf(s.birdY - targetY);
+}
+
+static bool better(const LookaheadNode& a, const LookaheadNode& b) {
+    return a.value > b.value;
+}
+
+bool lookaheadWantsFlap(Lookahead& search, const SimState& state) {
+    LookaheadNode* beam = search.pool;
+    LookaheadNode* children = search.pool + search.beamWidth;
+    int beamCount = 1;
+    simSnapshotTake(state, beam[0].state);
+    beam[0].value = 0;
+    beam[0].firstFlap = false;
+
+    // If every line dies, play the one that lived longest
+    bool fallbackFlap = false;
+    int fallbackDepth = -1;
+
+    for (int d = 0; d < search.depth; d++) {
+        int childCount = 0;
+        for (int b = 0; b < beamCount; b++) {
+            for (int flap = 0; flap < 2; flap++) {
+                LookaheadNode& child = children[childCount];
+                child.state = beam[b].state;
+                child.firstFlap = d == 0 ? flap != 0 : beam[b].firstFlap;
+                search.nodesExpanded++;
+                if (simSnapshotStep(child.state, flap != 0)) {
+                    if (d > fallbackDepth) {
+                        fallbackDepth = d;
+                        fallbackFlap = child.firstFlap;
+                    }
+                    continue;
+                }
+                child.value = evaluate(child.state);
+                childCount++;
+            }
+        }
+        if (childCount == 0) {
+            search.decisions++;
+            return fallbackFlap;
+        }
+
+        // Keep the best beamWidth children
+        beamCount = std::min(childCount, search.beamWidth);
+        std::partial_sort(children, children + beamCount, children + childCount, better);
+        memcpy(beam, children, beamCount * sizeof(LookaheadNode));
+    }
+
+    search.decisions++;
+    return beam[0].firstFlap;
+}
@@ -0,0 +1,38 @@
+// Lookahead autopilot
+// Decides each tick whether to flap by beam search over the future: the
+// state is cloned into SimSnapshot nodes, every node in the beam is
+// stepped once with and once without a flap, and the best beamWidth
+// children by a heuristic (pipes passed, then closeness to the next gap's
+// centre) survive to the next depth. The first action of the best node
+// after depth ticks is played. Nodes live in a pool allocated once, so a
+// decision allocates nothing.
+#ifndef FLAPPY_LOOKAHEAD_H
+#define FLAPPY_LOOKAHEAD_H
+
+#include "flappy_sim.h"
+
+#define LOOKAHEAD_BEAM_WIDTH 32
+#define LOOKAHEAD_DEPTH 60  // Ticks, about one second
+
+struct LookaheadNode {
+    SimSnapshot state;
+    float value;
+    bool firstFlap;  // Action at the root that led here
+};
+
+struct Lookahead {
+    int beamWidth;
+    int depth;
+    LookaheadNode* pool;   // beamWidth beam nodes, then 2 * beamWidth children
+    long nodesExpanded;    // Snapshot steps over all decisions
+    long decisions;
+};
+
+// False if the node pool cannot be allocated
+bool lookaheadInit(Lookahead& search, int beamWidth, int depth);
+void lookaheadFree(Lookahead& search);
+
+// Search from state and return whether to flap on its next step
+bool lookaheadWantsFlap(Lookahead& search, const SimState& state);
+
+#endif
@@ -0,0 +1,446 @@
+// Microbenchmarks of the per-frame path
+// Times the functions a frame is made of one at a time: simulation steps,
+// collision checks and pipe recycling, the scene tick, particle spawning and
+// updating at several pool fill levels, and each draw* function of the
+// scene under an offscreen context (flappy_offscreen.h), flushed and
+// finished so the rasterizer's work is included.
+//
+// Each benchmark is calibrated to MICRO_REP_MS per repetition (calibration
+// doubles as warmup), given MICRO_WARMUP_REPS more warmup repetitions, then
+// timed over reps repetitions. The median, mean, standard deviation and
+// minimum time per call are reported; the median is the figure to compare.
+// --json writes the results as JSON, and --compare reads such a file from
+// another build or commit and flags every benchmark whose median got slower
+// by more than the threshold (exit status 1 if any did).
+//
+// The draw benchmarks use the shader effects (flappy_render.h) when the
+// context runs them; --fixed-function times the fallback path instead.
+//
+// Usage: flappy_micro_bench [--reps N] [--time ms] [--filter TEXT] [--no-gl]
+//                           [--fixed-function] [--json FILE] [--compare FILE [percent]]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include "flappy_sim.h"
+#include "flappy_particles.h"
+#include "flappy_render.h"
+#include "flappy_text.h"
+#include "flappy_scene.h"
+#include "flappy_offscreen.h"
+#include "flappy_time.h"
+
+#define MICRO_SEED 12345
+#define MICRO_REPS 11
+#define MICRO_WARMUP_REPS 2
+#define MICRO_REP_MS 20.0
+#define MICRO_MAX_BENCHMARKS 64
+#define MICRO_COMPARE_PERCENT 10.0
+#define MICRO_BURST 16  // Particles per burst, as a flap or crash makes a few
+#define MICRO_GHOSTS 10000
+
+struct MicroBenchmark {
+    char name[48];
+    void (*setup)(int arg);  // Before every repetition, not timed
+    void (*body)(int arg, long calls);
+    int arg;
+    bool gl;  // Needs the offscreen context
+};
+
+struct MicroResult {
+    const char* name;
+    long calls;  // Per repetition
+    int reps;
+    double median, mean, stddev, min;  // Nanoseconds per call
+};
+
+static MicroBenchmark benchmarks[MICRO_MAX_BENCHMARKS];
+static int benchmarkCount = 0;
+static volatile int sink;  // Keeps results the compiler could drop
+
+static void add(const char* name, void (*setup)(int), void (*body)(int, long), int arg, bool gl) {
+    MicroBenchmark& b = benchmarks[benchmarkCount++];
+    snprintf(b.name, sizeof(b.name), "%s", name);
+    b.setup = setup;
+    b.body = body;
+    b.arg = arg;
+    b.gl = gl;
+}
+
+// Scripted bot: flap when falling below the centre of the next gap
+static bool botWantsFlap(const SimState& state) {
+    const Pipe* next = simNextPipe(state);
+    float targetY = next ? next->gapY + 10 : WINDOW_HEIGHT / 2;
+    return state.birdY > targetY && state.birdVelocity >= 0;
+}
+
+// Simulation, on its own state so the scene stays untouched
+static SimState world;
+
+static void setupWorld(int swept) {
+    simInit(world, MICRO_SEED);
+    simSetSweptCollision(world, swept != 0);
+    simRestart(world, MICRO_SEED);
+}
+
+// Steps of a bot run, restarting whenever the bird dies
+static void benchStep(int, long calls) {
+    for (long i = 0; i < calls; i++) {
+        SimInput input = { botWantsFlap(world) };
+        if (simStep(world, input).died) {
+            simReset(world);
+        }
+    }
+}
+
+// The bird at each height across the screen against the starting pipes
+static void benchCollision(int swept, long calls) {
+    int hits = 0;
+    for (long i = 0; i < calls; i++) {
+        float y = (float)(i % WINDOW_HEIGHT);
+        if (swept) {
+            hits += simCheckSweptCollision(world, y - 4, PIPE_SPEED);
+        } else {
+            world.birdY = y;
+            hits += simCheckCollision(world);
+        }
+    }
+    sink = hits;
+}
+
+// One pipe leaves the screen per call, as every PIPE_SPACING / PIPE_SPEED
+// ticks in play
+static void benchRecycle(int, long calls) {
+    for (long i = 0; i < calls; i++) {
+        world.scroll += world.pipeSpacing;
+        simRecyclePipes(world);
+        if (world.scroll >= SIM_SCROLL_REBASE) {
+            world.scroll -= SIM_SCROLL_REBASE;
+            for (int p = 0; p < world.pipeCount; p++) {
+                world.pipes[p].x -= SIM_SCROLL_REBASE;
+            }
+        }
+    }
+}
+
+// Scene tick while playing, as update() runs it
+static void setupPlaying(int) {
+    sceneReset(MICRO_SEED);
+    currentState = PLAYING;
+    resetGame();
+}
+
+static void benchTick(int, long calls) {
+    for (long i = 0; i < calls; i++) {
+        if (currentState != PLAYING) {
+            currentState = PLAYING;
+            resetGame();
+        }
+        if (botWantsFlap(sim)) {
+            sceneFlap();
+        }
+        tick();
+    }
+}
+
+// Particles: the scene pool with fill live particles that never expire, so
+// the fill level holds for the whole repetition
+static void setupParticles(int fill) {
+    particlesClear(particles);
+    particlesSeed(particles, MICRO_SEED);
+    for (int i = 0; i < fill; i++) {
+        Particle* p = particlesEmit(particles, 400, 300, 1.0f, 1.0f, 0.8f);
+        if (p) {
+            p->life = 1e30f;
+        }
+    }
+}
+
+// A burst of createParticles() calls; the pool is rewound to its fill
+// level after each, so every burst sees the same pool
+static void benchCreate(int fill, long calls) {
+    for (long i = 0; i < calls; i++) {
+        for (int k = 0; k < MICRO_BURST; k++) {
+            createParticles(400, 300, 1.0f, 1.0f, 1.0f);
+        }
+        particles.count = fill;
+    }
+}
+
+static void benchUpdate(int, long calls) {
+    for (long i = 0; i < calls; i++) {
+        updateParticles();
+    }
+}
+
+// Draw functions, on a frame of the screen that shows them
+enum DrawScreen {
+    DRAW_MENU, DRAW_INSTRUCTIONS, DRAW_PLAYING, DRAW_CELEBRATION, DRAW_GAME_OVER, DRAW_RACE
+};
+
+static void setupDraw(int screen) {
+    sceneReset(MICRO_SEED);
+    if (screen == DRAW_RACE && !racing) {
+        // Recorded once; every run from here on races them
+        sceneRace(NULL);
+        ghostRecordBots(ghosts, MICRO_GHOSTS, MICRO_SEED, NULL);
+    }
+    if (screen == DRAW_INSTRUCTIONS) {
+        currentState = INSTRUCTIONS;
+    } else if (screen != DRAW_MENU) {
+        setupPlaying(0);
+        for (int t = 0; t < 200 && currentState == PLAYING; t++) {
+            if (botWantsFlap(sim)) {
+                sceneFlap();
+            }
+            tick();
+        }
+        if (screen == DRAW_CELEBRATION) {
+            sim.score = 5;
+            sim.isCelebrating = true;
+            sim.celebrationTimer = CELEBRATION_DURATION / 2;
+        } else if (screen == DRAW_GAME_OVER) {
+            currentState = GAME_OVER;
+        }
+    }
+    sceneRender(3200, 0.5f);
+    glFinish();
+}
+
+static void drawCalls(void (*draw)(), long calls) {
+    for (long i = 0; i < calls; i++) {
+        draw();
+        batchFlush();
+    }
+    glFinish();
+}
+
+static void benchSky(int, long calls) { drawCalls(drawSky, calls); }
+static void benchPipes(int, long calls) { drawCalls(drawPipes, calls); }
+static void benchBird(int, long calls) { drawCalls(drawBird, calls); }
+static void benchParticles(int, long calls) { drawCalls(drawParticles, calls); }
+static void benchGround(int, long calls) { drawCalls(drawGround, calls); }
+static void benchScore(int, long calls) { drawCalls(drawScore, calls); }
+static void benchCelebration(int, long calls) { drawCalls(drawCelebration, calls); }
+static void benchMenu(int, long calls) { drawCalls(drawMenu, calls); }
+static void benchInstructions(int, long calls) { drawCalls(drawInstructions, calls); }
+static void benchGameOver(int, long calls) { drawCalls(drawGameOver, calls); }
+static void benchGhosts(int, long calls) { drawCalls(drawGhosts, calls); }
+
+static void addBenchmarks() {
+    add("sim/step", setupWorld, benchStep, 0, false);
+    add("sim/step_swept", setupWorld, benchStep, 1, false);
+    add("sim/collision", setupWorld, benchCollision, 0, false);
+    add("sim/collision_swept", setupWorld, benchCollision, 1, false);
+    add("sim/recycle_pipe", setupWorld, benchRecycle, 0, false);
+    add("scene/tick", setupPlaying, benchTick, 0, false);
+
+    const int fills[] = {0, DEFAULT_PARTICLE_CAPACITY / 16, DEFAULT_PARTICLE_CAPACITY / 2,
+                         DEFAULT_PARTICLE_CAPACITY - MICRO_BURST, DEFAULT_PARTICLE_CAPACITY};
+    char name[48];
+    for (int i = 0; i < 5; i++) {
+        snprintf(name, sizeof(name), "particles/create%d/fill%d", MICRO_BURST, fills[i]);
+        add(name, setupParticles, benchCreate, fills[i], false);
+    }
+    for (int i = 1; i < 5; i++) {
+        snprintf(name, sizeof(name), "particles/update/fill%d", fills[i]);
+        add(name, setupParticles, benchUpdate, fills[i], false);
+    }
+
+    add("draw/sky", setupDraw, benchSky, DRAW_PLAYING, true);
+    add("draw/pipes", setupDraw, benchPipes, DRAW_PLAYING, true);
+    add("draw/bird", setupDraw, benchBird, DRAW_PLAYING, true);
+    add("draw/particles", setupDraw, benchParticles, DRAW_PLAYING, true);
+    add("draw/ground", setupDraw, benchGround, DRAW_PLAYING, true);
+    add("draw/score", setupDraw, benchScore, DRAW_PLAYING, true);
+    add("draw/celebration", setupDraw, benchCelebration, DRAW_CELEBRATION, true);
+    add("draw/menu", setupDraw, benchMenu, DRAW_MENU, true);
+    add("draw/instructions", setupDraw, benchInstructions, DRAW_INSTRUCTIONS, true);
+    add("draw/game_over", setupDraw, benchGameOver, DRAW_GAME_OVER, true);
+    add("draw/ghosts10000", setupDraw, benchGhosts, DRAW_RACE, true);  // Last: starts the race
+}
+
+// Seconds for one repetition of calls
+static double timeRep(const MicroBenchmark& b, long calls) {
+    b.setup(b.arg);
+    double start = timeNow();
+    b.body(b.arg, calls);
+    return timeNow() - start;
+}
+
+static MicroResult run(const MicroBenchmark& b, int reps, double repSeconds) {
+    // Calibrate: double the calls until a repetition takes repSeconds
+    long calls = 1;
+    while (timeRep(b, calls) < repSeconds && calls < (1L << 40)) {
+        calls *= 2;
+    }
+    for (int r = 0; r < MICRO_WARMUP_REPS; r++) {
+        timeRep(b, calls);
+    }
+
+    double* samples = (double*)malloc(reps * sizeof(double));
+    double sum = 0;
+    for (int r = 0; r < reps; r++) {
+        samples[r] = timeRep(b, calls) / calls * 1e9;
+        sum += samples[r];
+    }
+    MicroResult result;
+    result.name = b.name;
+    result.calls = calls;
+    result.reps = reps;
+    result.mean = sum / reps;
+    double squares = 0;
+    for (int r = 0; r < reps; r++) {
+        squares += (samples[r] - result.mean) * (samples[r] - result.mean);
+    }
+    result.stddev = reps > 1 ? sqrt(squares / (reps - 1)) : 0;
+    std::sort(samples, samples + reps);
+    result.min = samples[0];
+    result.median = reps % 2 ? samples[reps / 2] : (samples[reps / 2 - 1] + samples[reps / 2]) / 2;
+    free(samples);
+    return result;
+}
+
+static bool writeJson(const char* path, const MicroResult* results, int count, const char* renderer) {
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "cannot write %s\n", path);
+        return false;
+    }
+    // One benchmark per line, which readBaseline() relies on
+    fprintf(f, "{\n  \"renderer\": \"%s\",\n  \"unit\": \"ns\",\n  \"benchmarks\": [\n", renderer);
+    for (int i = 0; i < count; i++) {
+        const MicroResult& r = results[i];
+        fprintf(f, "    {\"name\": \"%s\", \"median\": %.3f, \"mean\": %.3f, \"stddev\": %.3f, "
+                   "\"min\": %.3f, \"calls\": %ld, \"reps\": %d}%s\n",
+                r.name, r.median, r.mean, r.stddev, r.min, r.calls, r.reps, i + 1 < count ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    return true;
+}
+
+// Median of name in a file written by writeJson(), or -1
+static double baselineMedian(FILE* f, const char* name) {
+    char line[512], found[48];
+    double median;
+    rewind(f);
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, " {\"name\": \"%47[^\"]\", \"median\": %lf", found, &median) == 2 &&
+            strcmp(found, name) == 0) {
+            return median;
+        }
+    }
+    return -1;
+}
+
+int main(int argc, char** argv) {
+    int reps = MICRO_REPS;
+    double repSeconds = MICRO_REP_MS / 1000;
+    const char* filter = NULL;
+    const char* jsonPath = NULL;
+    const char* comparePath = NULL;
+    double comparePercent = MICRO_COMPARE_PERCENT;
+    bool useGL = true;
+    bool fixedFunction = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) {
+            reps = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--time") == 0 && i + 1 < argc) {
+            repSeconds = atof(argv[++i]) / 1000;
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc) {
+            comparePath = argv[++i];
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                comparePercent = atof(argv[++i]);
+            }
+        } else if (strcmp(argv[i], "--no-gl") == 0) {
+            useGL = false;
+        } else if (strcmp(argv[i], "--fixed-function") == 0) {
+            fixedFunction = true;
+        } else {
+            fprintf(stderr, "usage: %s [--reps N] [--time ms] [--filter TEXT] [--no-gl] "
+                            "[--fixed-function] [--json FILE] [--compare FILE [percent]]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+
+    FILE* baseline = NULL;
+    if (comparePath && !(baseline = fopen(comparePath, "r"))) {
+        fprintf(stderr, "cannot read %s\n", comparePath);
+        return 2;
+    }
+
+    if (useGL && !offscreenInit(WINDOW_WIDTH, WINDOW_HEIGHT)) {
+        printf("no offscreen context, skipping draw benchmarks\n");
+        useGL = false;
+    }
+    const char* renderer = useGL ? offscreenRenderer() : "none";
+    if (useGL) {
+        glClear(GL_COLOR_BUFFER_BIT);
+        textAtlasBuild(offscreenDrawGlyph, offscreenGlyphAdvance);
+        if (!fixedFunction) {
+            batchEffectsInit();
+        }
+    }
+    sceneInit(MICRO_SEED);
+    addBenchmarks();
+
+    printf("renderer: %s%s\n", renderer, batchEffectsActive() ? ", shader effects" : "");
+    printf("%d reps of ~%.0f ms after %d warmup, ns per call\n", reps, repSeconds * 1000,
+           MICRO_WARMUP_REPS);
+    printf("benchmark                            median         mean  stddev       min      calls%s\n",
+           baseline ? "   baseline  change" : "");
+
+    static MicroResult results[MICRO_MAX_BENCHMARKS];
+    int count = 0, slower = 0;
+    for (int i = 0; i < benchmarkCount; i++) {
+        const MicroBenchmark& b = benchmarks[i];
+        if ((b.gl && !useGL) || (filter && !strstr(b.name, filter))) {
+            continue;
+        }
+        MicroResult& r = results[count++] = run(b, reps, repSeconds);
+        printf("%-30s %12.1f %12.1f %6.1f%% %9.1f %10ld", r.name, r.median, r.mean,
+               r.mean > 0 ? r.stddev / r.mean * 100 : 0, r.min, r.calls);
+        if (baseline) {
+            double before = baselineMedian(baseline, r.name);
+            if (before > 0) {
+                double change = (r.median / before - 1) * 100;
+                bool regressed = change > comparePercent;
+                slower += regressed;
+                printf(" %10.1f %+6.1f%%%s", before, change, regressed ? "  SLOWER" : "");
+            } else {
+                printf(" %10s", "-");
+            }
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+
+    int result = 0;
+    if (jsonPath && !writeJson(jsonPath, results, count, renderer)) {
+        result = 2;
+    }
+    if (baseline) {
+        fclose(baseline);
+        printf("%d of %d benchmarks slower than %s by more than %.0f%%\n", slower, count,
+               comparePath, comparePercent);
+        if (slower > 0 && result == 0) {
+            result = 1;
+        }
+    }
+
+    particlesFree(particles);
+    if (useGL) {
+        textAtlasFree();
+        sceneFreeLayers();
+        sceneStopRace();
+        offscreenShutdown();
+    }
+    return result;
+}
@@ -0,0 +1,105 @@
+#include "flappy_offscreen.h"
+#include "flappy_gl.h"
+#include "flappy_text.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <stdio.h>
+
+static EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+static EGLContext eglContext = EGL_NO_CONTEXT;
+static EGLSurface eglSurface = EGL_NO_SURFACE;
+
+static GLubyte fontGlyphs[TEXT_LAST_CHAR + 1][OFFSCREEN_GLYPH_HEIGHT * 2];
+static bool fontReady = false;
+
+bool offscreenInit(int width, int height) {
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay) {
+        eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    }
+    if (eglDisplay == EGL_NO_DISPLAY) {
+        eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint major, minor;
+    if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor)) {
+        fprintf(stderr, "offscreen: cannot initialize EGL\n");
+        return false;
+    }
+    eglBindAPI(EGL_OPENGL_API);
+
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(eglDisplay, configAttribs, &config, 1, &configCount) || configCount == 0) {
+        fprintf(stderr, "offscreen: no pbuffer-capable EGL config\n");
+        return false;
+    }
+
+    const EGLint surfaceAttribs[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+    eglSurface = eglCreatePbufferSurface(eglDisplay, config, surfaceAttribs);
+    eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, NULL);
+    if (eglSurface == EGL_NO_SURFACE || eglContext == EGL_NO_CONTEXT ||
+        !eglMakeCurrent(eglDisplay, eglSurface, eglSurface, eglContext)) {
+        fprintf(stderr, "offscreen: cannot create context (0x%x)\n", eglGetError());
+        return false;
+    }
+
+    // Same projection as reshape() in the game
+    glViewport(0, 0, width, height);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glOrtho(0, width, height, 0, -1, 1);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    return true;
+}
+
+void offscreenShutdown() {
+    if (eglDisplay != EGL_NO_DISPLAY) {
+        eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (eglContext != EGL_NO_CONTEXT) eglDestroyContext(eglDisplay, eglContext);
+        if (eglSurface != EGL_NO_SURFACE) eglDestroySurface(eglDisplay, eglSurface);
+        eglTerminate(eglDisplay);
+    }
+    eglDisplay = EGL_NO_DISPLAY;
+    eglContext = EGL_NO_CONTEXT;
+    eglSurface = EGL_NO_SURFACE;
+}
+
+const char* offscreenRenderer() {
+    const GLubyte* renderer = glGetString(GL_RENDERER);
+    return renderer ? (const char*)renderer : "unknown";
+}
+
+// One character at the raster position, as glutBitmapCharacter() does it
+void offscreenDrawGlyph(int c) {
+    if (!fontReady) {
+        for (int ch = TEXT_FIRST_CHAR + 1; ch <= TEXT_LAST_CHAR; ch++) {
+            for (int row = 0; row < OFFSCREEN_GLYPH_HEIGHT; row++) {
+                unsigned int bits = (ch * 2654435761u) >> (row % 16);
+                fontGlyphs[ch][row * 2] = (GLubyte)bits;
+                fontGlyphs[ch][row * 2 + 1] = (GLubyte)(bits >> 8) & 0x80;
+            }
+        }
+        fontReady = true;
+    }
+    if (c < 0 || c > TEXT_LAST_CHAR) {
+        return;
+    }
+    glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBitmap(OFFSCREEN_GLYPH_WIDTH, OFFSCREEN_GLYPH_HEIGHT, 0, 3, OFFSCREEN_GLYPH_WIDTH + 1, 0,
+             fontGlyphs[c]);
+    glPopClientAttrib();
+}
+
+int offscreenGlyphAdvance(int /* c */) {
+    return OFFSCREEN_GLYPH_WIDTH + 1;
+}
@@ -0,0 +1,22 @@
+// Offscreen OpenGL context
+// Creates a window-less EGL context (Mesa surfaceless platform, e.g. llvmpipe
+// software rendering) so drawing code can run on machines without a display.
+#ifndef FLAPPY_OFFSCREEN_H
+#define FLAPPY_OFFSCREEN_H
+
+// Create and make current a width x height context with the game's 2D
+// projection; returns false if no EGL/OpenGL implementation is available
+bool offscreenInit(int width, int height);
+void offscreenShutdown();
+
+// GL_RENDERER string of the current context
+const char* offscreenRenderer();
+
+// Stand-in bitmap font for textAtlasBuild(), since GLUT's fonts need a
+// window: 9x13 glyphs with a fixed pattern that depends on the character
+#define OFFSCREEN_GLYPH_WIDTH 9
+#define OFFSCREEN_GLYPH_HEIGHT 13
+void offscreenDrawGlyph(int c);
+int offscreenGlyphAdvance(int c);
+
+#endif
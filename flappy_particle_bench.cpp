@@ -0,0 +1,125 @@
+// Particle pool benchmark
+// Emits bursts of different sizes into the pool and updates it each tick,
+// reporting spawn/update cost per particle and the worst tick. The old
+// first-free-slot scan is timed alongside for the smaller bursts.
+//
+// Usage: flappy_particle_bench [ticks]
+#include <stdio.h>
+#include <stdlib.h>
+#include "flappy_particles.h"
+#include "flappy_time.h"
+
+#define BURST_INTERVAL 10  // ticks between bursts
+
+// Previous particle array: each spawn scans for the first inactive slot
+struct LegacyParticle {
+    Particle p;
+    bool active;
+};
+
+static void legacyCreate(LegacyParticle* particles, int capacity, float x, float y) {
+    for (int i = 0; i < capacity; i++) {
+        if (!particles[i].active) {
+            Particle& p = particles[i].p;
+            p.x = x;
+            p.y = y;
+            p.vx = (rand() % 100 - 50) / 25.0f;
+            p.vy = (rand() % 100 - 50) / 25.0f;
+            p.life = 1.0f;
+            p.size = 2.0f + (rand() % 3);
+            particles[i].active = true;
+            break;
+        }
+    }
+}
+
+static void legacyUpdate(LegacyParticle* particles, int capacity) {
+    for (int i = 0; i < capacity; i++) {
+        if (particles[i].active) {
+            Particle& p = particles[i].p;
+            p.x += p.vx;
+            p.y += p.vy;
+            p.vy += 0.1f;
+            p.life -= 0.02f;
+            if (rand() % 10 == 0) {
+                p.vx += (rand() % 20 - 10) / 50.0f;
+            }
+            if (p.life <= 0) {
+                particles[i].active = false;
+            }
+        }
+    }
+}
+
+static void benchPool(int burst, int capacity, int ticks) {
+    ParticlePool pool;
+    particlesInit(pool, capacity);
+    const float colors[][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+
+    double spawnTime = 0, updateTime = 0, worstTick = 0;
+    long spawned = 0, updated = 0;
+    int peak = 0;
+    for (int t = 0; t < ticks; t++) {
+        double start = timeNow();
+        if (t % BURST_INTERVAL == 0) {
+            spawned += particlesBurst(pool, burst, 400, 300, colors, 3);
+        }
+        double mid = timeNow();
+        updated += pool.count;
+        particlesUpdate(pool);
+        double end = timeNow();
+
+        spawnTime += mid - start;
+        updateTime += end - mid;
+        if (end - start > worstTick) worstTick = end - start;
+        if (pool.count > peak) peak = pool.count;
+    }
+
+    printf("pool    burst %6d  peak live %7d  spawn %6.1f ns/p  update %6.1f ns/p  worst tick %8.3f ms\n",
+           burst, peak, spawnTime / spawned * 1e9, updateTime / updated * 1e9, worstTick * 1000);
+    particlesFree(pool);
+}
+
+static void benchLegacy(int burst, int capacity, int ticks) {
+    LegacyParticle* particles = (LegacyParticle*)calloc(capacity, sizeof(LegacyParticle));
+
+    double spawnTime = 0, updateTime = 0, worstTick = 0;
+    long spawned = 0;
+    for (int t = 0; t < ticks; t++) {
+        double start = timeNow();
+        if (t % BURST_INTERVAL == 0) {
+            for (int i = 0; i < burst; i++) {
+                legacyCreate(particles, capacity, 400, 300);
+            }
+            spawned += burst;
+        }
+        double mid = timeNow();
+        legacyUpdate(particles, capacity);
+        double end = timeNow();
+
+        spawnTime += mid - start;
+        updateTime += end - mid;
+        if (end - start > worstTick) worstTick = end - start;
+    }
+
+    printf("legacy  burst %6d  capacity  %7d  spawn %6.1f ns/p  update %8.3f ms/tick  worst tick %8.3f ms\n",
+           burst, capacity, spawnTime / spawned * 1e9, updateTime / ticks * 1000, worstTick * 1000);
+    free(particles);
+}
+
+int main(int argc, char** argv) {
+    int ticks = argc > 1 ? atoi(argv[1]) : 500;
+    const int bursts[] = {10, 100, 1000, 10000, 100000};
+
+    srand(1);
+    for (int i = 0; i < 5; i++) {
+        // A particle lives 50 ticks, so at most 5 bursts are alive at once
+        int capacity = bursts[i] * (50 / BURST_INTERVAL + 1);
+        benchPool(bursts[i], capacity, ticks);
+    }
+    for (int i = 0; i < 4; i++) {
+        int capacity = bursts[i] * (50 / BURST_INTERVAL + 1);
+        benchLegacy(bursts[i], capacity, ticks);
+    }
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include "flappy_particles.h"
+#include <stdlib.h>
+
+void particlesInit(ParticlePool& pool, int capacity) {
+    pool.items = (Particle*)malloc(capacity * sizeof(Particle));
+    pool.count = 0;
+    pool.capacity = pool.items ? capacity : 0;
+    particlesSeed(pool, 0);
+}
+
+void particlesFree(ParticlePool& pool) {
+    free(pool.items);
+    pool.items = NULL;
+    pool.count = 0;
+    pool.capacity = 0;
+}
+
+void particlesClear(ParticlePool& pool) {
+    pool.count = 0;
+}
+
+void particlesSeed(ParticlePool& pool, uint64_t seed) {
+    randomSeed(pool.rng, seed, RANDOM_STREAM_EFFECTS);
+}
+
+// Create particles at position
+Particle* particlesEmit(ParticlePool& pool, float x, float y, float r, float g, float b) {
+    if (pool.count >= pool.capacity) {
+        return NULL;
+    }
+
+    Particle& p = pool.items[pool.count++];
+    p.x = x;
+    p.y = y;
+    p.prevX = x;
+    p.prevY = y;
+    p.vx = (randomRange(pool.rng, 100) - 50) / 25.0f;
+    p.vy = (randomRange(pool.rng, 100) - 50) / 25.0f;
+    p.life = 1.0f;
+    p.r = r;
+    p.g = g;
+    p.b = b;
+    p.size = 2.0f + randomRange(pool.rng, 3);  // Random size
+    return &p;
+}
+
+int particlesBurst(ParticlePool& pool, int count, float x, float y,
+                   const float (*colors)[3], int colorCount) {
+    int room = pool.capacity - pool.count;
+    if (count > room) {
+        count = room;
+    }
+    for (int i = 0; i < count; i++) {
+        const float* c = colors[i % colorCount];
+        particlesEmit(pool, x, y, c[0], c[1], c[2]);
+    }
+    return count;
+}
+
+// Update particles
+void particlesUpdate(ParticlePool& pool) {
+    int i = 0;
+    while (i < pool.count) {
+        Particle& p = pool.items[i];
+        p.prevX = p.x;
+        p.prevY = p.y;
+        p.x += p.vx;
+        p.y += p.vy;
+        p.vy += 0.1f; // Gravity effect
+        p.life -= 0.02f;
+
+        // Add some random movement
+        if (randomRange(pool.rng, 10) == 0) {
+            p.vx += (randomRange(pool.rng, 20) - 10) / 50.0f;
+        }
+
+        if (p.life <= 0) {
+            // Swap the last live particle into this slot and revisit it
+            pool.items[i] = pool.items[--pool.count];
+        } else {
+            i++;
+        }
+    }
+}
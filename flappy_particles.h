@@ -0,0 +1,47 @@
+// Particle system
+// Live particles are kept packed at the front of a preallocated pool, so
+// spawning appends and expiring swaps the last live particle into the hole:
+// both O(1), with no scan over free slots.
+#ifndef FLAPPY_PARTICLES_H
+#define FLAPPY_PARTICLES_H
+
+#include "flappy_random.h"
+
+#define DEFAULT_PARTICLE_CAPACITY 4096
+
+struct Particle {
+    float x, y;
+    float prevX, prevY;  // Position at the previous tick, for interpolation
+    float vx, vy;
+    float life;
+    float r, g, b;
+    float size;
+};
+
+struct ParticlePool {
+    Particle* items;  // items[0 .. count) are live
+    int count;
+    int capacity;
+    Random rng;  // Effects stream: velocities, sizes, jitter
+};
+
+// Allocate room for capacity particles
+void particlesInit(ParticlePool& pool, int capacity);
+void particlesFree(ParticlePool& pool);
+void particlesClear(ParticlePool& pool);
+
+// Restart the effects stream from seed
+void particlesSeed(ParticlePool& pool, uint64_t seed);
+
+// Create one particle at position; returns NULL when the pool is full
+Particle* particlesEmit(ParticlePool& pool, float x, float y, float r, float g, float b);
+
+// Create count particles at position, cycling through colorCount colors;
+// returns how many were created
+int particlesBurst(ParticlePool& pool, int count, float x, float y,
+                   const float (*colors)[3], int colorCount);
+
+// Move, age and expire particles by one tick
+void particlesUpdate(ParticlePool& pool);
+
+#endif
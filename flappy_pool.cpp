@@ -0,0 +1,172 @@
+#include "flappy_pool.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct PoolChunk {
+    int begin, end;
+};
+
+// Chunks of one thread; the owner pops the back, thieves the front
+struct PoolDeque {
+    std::mutex lock;
+    std::deque<PoolChunk> chunks;
+};
+
+struct ThreadPool {
+    int threadCount;
+    std::vector<std::thread> threads;  // threadCount - 1 workers
+    PoolDeque* deques;                 // One per thread, the caller's first
+
+    // Current job
+    PoolTask task;
+    void* context;
+    std::atomic<int> pending;  // Chunks not finished yet
+    std::atomic<long> steals;
+
+    // Workers sleep between jobs
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable done;
+    unsigned int job;  // Bumped for every job
+    bool stopping;
+};
+
+static bool popOwn(PoolDeque& deque, PoolChunk& chunk) {
+    std::lock_guard<std::mutex> guard(deque.lock);
+    if (deque.chunks.empty()) {
+        return false;
+    }
+    chunk = deque.chunks.back();
+    deque.chunks.pop_back();
+    return true;
+}
+
+static bool steal(ThreadPool* pool, int self, PoolChunk& chunk) {
+    for (int i = 1; i < pool->threadCount; i++) {
+        PoolDeque& victim = pool->deques[(self + i) % pool->threadCount];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.chunks.empty()) {
+            chunk = victim.chunks.front();
+            victim.chunks.pop_front();
+            pool->steals++;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Work until no thread has chunks left
+static void runChunks(ThreadPool* pool, int self) {
+    PoolChunk chunk;
+    while (popOwn(pool->deques[self], chunk) || steal(pool, self, chunk)) {
+        pool->task(pool->context, chunk.begin, chunk.end);
+        if (--pool->pending == 0) {
+            std::lock_guard<std::mutex> guard(pool->lock);
+            pool->done.notify_all();
+        }
+    }
+}
+
+static void workerMain(ThreadPool* pool, int self) {
+    unsigned int seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> guard(pool->lock);
+            pool->wake.wait(guard, [&] { return pool->stopping || pool->job != seen; });
+            if (pool->stopping) {
+                return;
+            }
+            seen = pool->job;
+        }
+        runChunks(pool, self);
+    }
+}
+
+ThreadPool* poolCreate(int threads) {
+    if (threads <= 0) {
+        threads = (int)std::thread::hardware_concurrency();
+    }
+    if (threads <= 0) {
+        threads = 1;
+    }
+
+    ThreadPool* pool = new ThreadPool();
+    pool->threadCount = threads;
+    pool->deques = new PoolDeque[threads];
+    pool->task = NULL;
+    pool->context = NULL;
+    pool->pending = 0;
+    pool->steals = 0;
+    pool->job = 0;
+    pool->stopping = false;
+    for (int t = 1; t < threads; t++) {
+        pool->threads.push_back(std::thread(workerMain, pool, t));
+    }
+    return pool;
+}
+
+void poolDestroy(ThreadPool* pool) {
+    if (!pool) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> guard(pool->lock);
+        pool->stopping = true;
+    }
+    pool->wake.notify_all();
+    for (size_t t = 0; t < pool->threads.size(); t++) {
+        pool->threads[t].join();
+    }
+    delete[] pool->deques;
+    delete pool;
+}
+
+int poolThreadCount(const ThreadPool* pool) {
+    return pool->threadCount;
+}
+
+long poolSteals(const ThreadPool* pool) {
+    return pool->steals;
+}
+
+void poolParallelFor(ThreadPool* pool, int count, int grain, PoolTask task, void* context) {
+    if (count <= 0) {
+        return;
+    }
+    if (grain < 1) {
+        grain = 1;
+    }
+    int chunks = (count + grain - 1) / grain;
+    if (pool->threadCount == 1 || chunks == 1) {
+        task(context, 0, count);
+        return;
+    }
+
+    // Deal the chunks out in contiguous runs, so each thread starts on
+    // neighbouring items and only stealing crosses the runs
+    pool->task = task;
+    pool->context = context;
+    pool->pending = chunks;
+    for (int t = 0; t < pool->threadCount; t++) {
+        int first = (int)((long)chunks * t / pool->threadCount);
+        int last = (int)((long)chunks * (t + 1) / pool->threadCount);
+        std::lock_guard<std::mutex> guard(pool->deques[t].lock);
+        for (int c = first; c < last; c++) {
+            PoolChunk chunk = { c * grain, c + 1 < chunks ? (c + 1) * grain : count };
+            pool->deques[t].chunks.push_back(chunk);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> guard(pool->lock);
+        pool->job++;
+    }
+    pool->wake.notify_all();
+
+    runChunks(pool, 0);
+    std::unique_lock<std::mutex> guard(pool->lock);
+    pool->done.wait(guard, [&] { return pool->pending == 0; });
+}
@@ -0,0 +1,31 @@
+// Work-stealing thread pool
+// A parallel for over an index range. The range is cut into chunks and
+// dealt out in contiguous runs, one deque per thread; each thread works
+// through its own deque from the back and, when it runs dry, steals from
+// the front of another's, so a thread left with short chunks (e.g. games
+// that last ten ticks rather than ten thousand) takes over work from one
+// with long chunks instead of going idle.
+// The calling thread works as one of the threads.
+#ifndef FLAPPY_POOL_H
+#define FLAPPY_POOL_H
+
+// Process items [begin, end) of the range
+typedef void (*PoolTask)(void* context, int begin, int end);
+
+struct ThreadPool;
+
+// Start a pool of threads workers in total, including the caller
+// (0 for one per hardware thread)
+ThreadPool* poolCreate(int threads);
+void poolDestroy(ThreadPool* pool);
+
+int poolThreadCount(const ThreadPool* pool);
+
+// Chunks taken from another thread's deque since the pool started
+long poolSteals(const ThreadPool* pool);
+
+// Run task over [0, count) in chunks of at most grain items, and return
+// once every chunk is done. Not reentrant: one call at a time per pool.
+void poolParallelFor(ThreadPool* pool, int count, int grain, PoolTask task, void* context);
+
+#endif
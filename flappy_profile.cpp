@@ -0,0 +1,185 @@
+#include "flappy_profile.h"
+
+#ifdef FLAPPY_PROFILE
+
+#include "flappy_render.h"
+#include "flappy_text.h"
+#include "flappy_sim.h"
+#include "flappy_time.h"
+#include <stdio.h>
+#include <algorithm>
+
+// Overlay layout
+#define OVERLAY_WIDTH 310
+#define OVERLAY_LINE 20
+#define OVERLAY_GRAPH_HEIGHT 60
+#define OVERLAY_GRAPH_MAX_MS 33.3f  // Top of the graph, two frames at 60 Hz
+#define OVERLAY_TARGET_MS 16.7f
+
+struct ProfileEvent {
+    double start, end;  // timeNow() seconds
+    int zone;
+};
+
+static const char* zoneNames[PROFILE_ZONE_COUNT] = {
+    "update", "update particles", "sky", "pipes", "bird", "ghosts", "particles",
+    "ground", "text", "flush", "swap", "display"
+};
+
+static ProfileEvent events[PROFILE_EVENT_CAPACITY];
+static long eventCount = 0;
+
+static double zoneTotals[PROFILE_ZONE_COUNT];  // Seconds in the current frame
+static float zoneHistory[PROFILE_HISTORY][PROFILE_ZONE_COUNT];  // ms per frame
+static float frameHistory[PROFILE_HISTORY];  // ms between frames
+static long frameCount = 0;
+static double lastFrameEnd = 0;
+static bool overlayVisible = false;
+
+ProfileScope::ProfileScope(ProfileZone zone) : zone(zone), start(timeNow()) {
+}
+
+ProfileScope::~ProfileScope() {
+    double end = timeNow();
+    ProfileEvent& event = events[eventCount % PROFILE_EVENT_CAPACITY];
+    event.start = start;
+    event.end = end;
+    event.zone = zone;
+    eventCount++;
+    zoneTotals[zone] += end - start;
+}
+
+void profileFrameEnd() {
+    double now = timeNow();
+    int slot = frameCount % PROFILE_HISTORY;
+    for (int z = 0; z < PROFILE_ZONE_COUNT; z++) {
+        zoneHistory[slot][z] = zoneTotals[z] * 1000;
+        zoneTotals[z] = 0;
+    }
+    frameHistory[slot] = lastFrameEnd > 0 ? (now - lastFrameEnd) * 1000 : 0;
+    lastFrameEnd = now;
+    frameCount++;
+}
+
+void profileToggleOverlay() {
+    overlayVisible = !overlayVisible;
+}
+
+// Average and 99th percentile of count values stride floats apart
+static void rollingStats(const float* values, int stride, int count, float& avg, float& p99) {
+    float sorted[PROFILE_HISTORY];
+    float sum = 0;
+    for (int i = 0; i < count; i++) {
+        sorted[i] = values[i * stride];
+        sum += sorted[i];
+    }
+    int rank = (count - 1) * 99 / 100;
+    std::nth_element(sorted, sorted + rank, sorted + count);
+    avg = sum / count;
+    p99 = sorted[rank];
+}
+
+static void overlayQuad(float x1, float y1, float x2, float y2) {
+    batchBegin(GL_QUADS);
+    batchVertex2f(x1, y1);
+    batchVertex2f(x2, y1);
+    batchVertex2f(x2, y2);
+    batchVertex2f(x1, y2);
+    batchEnd();
+}
+
+static void overlayRow(float x, float y, const char* name, float avg, float p99) {
+    char number[16];
+    batchText(x, y, name);
+    sprintf(number, "%.2f", avg);
+    batchText(x + 175, y, number);
+    sprintf(number, "%.2f", p99);
+    batchText(x + 240, y, number);
+}
+
+void profileDrawOverlay() {
+    int frames = frameCount < PROFILE_HISTORY ? (int)frameCount : PROFILE_HISTORY;
+    if (!overlayVisible || frames == 0) {
+        return;
+    }
+
+    float left = WINDOW_WIDTH - OVERLAY_WIDTH - 10;
+    float top = 10;
+    float height = (PROFILE_ZONE_COUNT + 2) * OVERLAY_LINE + OVERLAY_GRAPH_HEIGHT + 20;
+    batchColor4f(0.0f, 0.0f, 0.0f, 0.7f);
+    overlayQuad(left, top, left + OVERLAY_WIDTH, top + height);
+
+    // Rolling averages and p99 over the history, in ms
+    float x = left + 10;
+    float y = top + OVERLAY_LINE;
+    float avg, p99;
+    batchColor3f(1.0f, 0.8f, 0.0f);
+    batchText(x, y, "ms");
+    batchText(x + 175, y, "avg");
+    batchText(x + 240, y, "p99");
+    y += OVERLAY_LINE;
+    rollingStats(frameHistory, 1, frames, avg, p99);
+    batchColor3f(1.0f, 1.0f, 1.0f);
+    overlayRow(x, y, "frame", avg, p99);
+    for (int z = 0; z < PROFILE_ZONE_COUNT; z++) {
+        y += OVERLAY_LINE;
+        rollingStats(&zoneHistory[0][z], PROFILE_ZONE_COUNT, frames, avg, p99);
+        overlayRow(x, y, zoneNames[z], avg, p99);
+    }
+
+    // Frame-time graph, oldest frame on the left, with the 60 Hz budget
+    float graphBottom = top + height - 10;
+    float barWidth = (float)(OVERLAY_WIDTH - 20) / PROFILE_HISTORY;
+    for (int i = 0; i < frames; i++) {
+        float ms = frameHistory[(frameCount - frames + i) % PROFILE_HISTORY];
+        float barHeight = std::min(ms, OVERLAY_GRAPH_MAX_MS) / OVERLAY_GRAPH_MAX_MS * OVERLAY_GRAPH_HEIGHT;
+        if (ms > OVERLAY_TARGET_MS * 1.5f) {
+            batchColor3f(1.0f, 0.2f, 0.2f);
+        } else {
+            batchColor3f(0.2f, 0.9f, 0.4f);
+        }
+        float barX = x + (PROFILE_HISTORY - frames + i) * barWidth;
+        overlayQuad(barX, graphBottom - barHeight, barX + barWidth, graphBottom);
+    }
+    float targetY = graphBottom - OVERLAY_TARGET_MS / OVERLAY_GRAPH_MAX_MS * OVERLAY_GRAPH_HEIGHT;
+    batchColor3f(1.0f, 0.8f, 0.0f);
+    batchBegin(GL_LINES);
+    batchVertex2f(x, targetY);
+    batchVertex2f(x + OVERLAY_WIDTH - 20, targetY);
+    batchEnd();
+
+    batchFlush();
+}
+
+bool profileWriteTrace(const char* path) {
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "profile: cannot write %s\n", path);
+        return false;
+    }
+
+    // Oldest event still in the ring; timestamps start at the earliest one
+    long first = eventCount > PROFILE_EVENT_CAPACITY ? eventCount - PROFILE_EVENT_CAPACITY : 0;
+    double origin = 0;
+    for (long i = first; i < eventCount; i++) {
+        double start = events[i % PROFILE_EVENT_CAPACITY].start;
+        if (i == first || start < origin) {
+            origin = start;
+        }
+    }
+
+    fprintf(f, "{\"traceEvents\":[\n");
+    for (long i = first; i < eventCount; i++) {
+        const ProfileEvent& event = events[i % PROFILE_EVENT_CAPACITY];
+        fprintf(f, "{\"name\":\"%s\",\"cat\":\"flappy\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                   "\"pid\":1,\"tid\":1}%s\n",
+                zoneNames[event.zone], (event.start - origin) * 1e6,
+                (event.end - event.start) * 1e6, i + 1 < eventCount ? "," : "");
+    }
+    fprintf(f, "],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(f);
+    printf("profile: wrote %ld events to %s\n", eventCount - first, path);
+    return true;
+}
+
+#endif
@@ -0,0 +1,68 @@
+// Frame profiler
+// Scoped timers on the game's subsystems, recorded into a fixed ring buffer
+// (no allocation per event). The game shows rolling averages, p99 and a
+// frame-time graph in an overlay and can export the captured events as a
+// Chrome trace (chrome://tracing, Perfetto).
+//
+// Only built with -DFLAPPY_PROFILE: otherwise PROFILE_SCOPE() expands to
+// nothing and the functions below are empty inlines.
+#ifndef FLAPPY_PROFILE_H
+#define FLAPPY_PROFILE_H
+
+enum ProfileZone {
+    PROFILE_UPDATE,          // update(): fixed ticks for one timer callback
+    PROFILE_PARTICLES,       // updateParticles()
+    PROFILE_SKY,             // drawSky()
+    PROFILE_PIPES,           // drawPipes()
+    PROFILE_BIRD,            // drawBird()
+    PROFILE_GHOSTS,          // drawGhosts()
+    PROFILE_DRAW_PARTICLES,  // drawParticles()
+    PROFILE_GROUND,          // drawGround()
+    PROFILE_TEXT,            // renderText() and the celebration message
+    PROFILE_FLUSH,           // batchFlush() at the end of the frame
+    PROFILE_SWAP,            // glutSwapBuffers()
+    PROFILE_DISPLAY,         // all of display()
+    PROFILE_ZONE_COUNT
+};
+
+#define PROFILE_EVENT_CAPACITY 65536  // Events kept for the trace
+#define PROFILE_HISTORY 240           // Frames kept for averages and the graph
+
+#ifdef FLAPPY_PROFILE
+
+// Time from construction to the end of the enclosing scope
+struct ProfileScope {
+    ProfileZone zone;
+    double start;
+    ProfileScope(ProfileZone zone);
+    ~ProfileScope();
+};
+
+#define PROFILE_JOIN2(a, b) a##b
+#define PROFILE_JOIN(a, b) PROFILE_JOIN2(a, b)
+#define PROFILE_SCOPE(zone) ProfileScope PROFILE_JOIN(profileScope, __LINE__)(zone)
+
+// Close the current frame: per-zone totals since the last call go into the
+// history, together with the time between the two calls
+void profileFrameEnd();
+
+void profileToggleOverlay();
+
+// Draw the overlay through the batch (and flush it) when it is shown
+void profileDrawOverlay();
+
+// Write the events still in the ring buffer as Chrome trace JSON
+bool profileWriteTrace(const char* path);
+
+#else
+
+#define PROFILE_SCOPE(zone)
+
+static inline void profileFrameEnd() {}
+static inline void profileToggleOverlay() {}
+static inline void profileDrawOverlay() {}
+static inline bool profileWriteTrace(const char*) { return false; }
+
+#endif
+
+#endif
@@ -0,0 +1,9 @@
+#include "flappy_random.h"
+
+void randomSeed(Random& rng, uint64_t seed, uint64_t stream) {
+    rng.state = 0;
+    rng.inc = (stream << 1) | 1;
+    randomNext(rng);
+    rng.state += seed;
+    randomNext(rng);
+}
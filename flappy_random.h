@@ -0,0 +1,38 @@
+// Deterministic random numbers
+// PCG32 (pcg-random.org): 64-bit state, 32-bit output, and an odd increment
+// that selects one of 2^63 independent streams. Each subsystem owns its own
+// generator, so the pipe layout for a seed does not depend on how many
+// particles were spawned, and nothing is shared (or locked) between threads.
+#ifndef FLAPPY_RANDOM_H
+#define FLAPPY_RANDOM_H
+
+#include <stdint.h>
+
+// Stream ids
+#define RANDOM_STREAM_LEVEL 1    // Pipe gaps
+#define RANDOM_STREAM_EFFECTS 2  // Particles and other cosmetics
+#define RANDOM_STREAM_GHOSTS 3   // Aim of recorded ghost bots
+
+struct Random {
+    uint64_t state;
+    uint64_t inc;  // Stream selector, always odd
+};
+
+// Start a generator; the same seed and stream always give the same numbers
+void randomSeed(Random& rng, uint64_t seed, uint64_t stream);
+
+// Next 32 random bits
+static inline uint32_t randomNext(Random& rng) {
+    uint64_t old = rng.state;
+    rng.state = old * 6364136223846793005ULL + rng.inc;
+    uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+    uint32_t rot = (uint32_t)(old >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+}
+
+// Integer in [0, n) by multiply-shift instead of a division
+static inline int randomRange(Random& rng, int n) {
+    return (int)(((uint64_t)randomNext(rng) * (uint32_t)n) >> 32);
+}
+
+#endif
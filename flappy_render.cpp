@@ -0,0 +1,683 @@
+#include "flappy_render.h"
+#include "flappy_shader.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define BATCH_MATRIX_DEPTH 8
+#define BATCH_PRIMITIVE_VERTICES 64  // Longest single batchBegin()/batchEnd()
+#define BATCH_RUN_SEGMENTS 64        // Effects program switches within a run
+
+RenderStats renderStats;
+
+// One run of vertices drawn with a single glDrawArrays; storage is reused
+// across frames and grows to the largest frame seen
+struct VertexRun {
+    ColorVertex* vertices;
+    int count;
+    int capacity;
+    bool translucent;
+    // Where the run switches between plain and soft shape vertices, which
+    // are drawn by different effects programs; none for a plain run
+    int segmentCount;
+    int segmentStart[BATCH_RUN_SEGMENTS];
+    bool segmentSoft[BATCH_RUN_SEGMENTS];
+};
+
+static VertexRun triangles = {NULL, 0, 0, false, 0, {0}, {false}};
+static VertexRun lines = {NULL, 0, 0, false, 0, {0}, {false}};
+
+// Textured quads as triangles, all from one texture
+static TexVertex* quadVertices = NULL;
+static int quadCount = 0;  // vertices
+static int quadCapacity = 0;
+static GLuint quadTexture = 0;
+
+// Screen-space bounds of what is drawn after the triangles
+struct Bounds {
+    float minX, minY, maxX, maxY;
+};
+
+static Bounds lineBounds;
+static Bounds quadBounds;
+
+// x' = a*x + c*y + tx, y' = b*x + d*y + ty
+struct BatchMatrix {
+    float a, b, c, d, tx, ty;
+};
+
+static BatchMatrix matrixStack[BATCH_MATRIX_DEPTH] = {{1, 0, 0, 1, 0, 0}};
+static int matrixTop = 0;
+
+// Primitive being recorded
+static GLenum primitiveMode;
+static ColorVertex primitive[BATCH_PRIMITIVE_VERTICES];
+static int primitiveCount = 0;
+static GLubyte currentColor[4] = {255, 255, 255, 255};
+static GLubyte currentEffect[4] = {0, 0, 0, 0};
+
+// Effects programs: one for runs of waves and plain color, and one that
+// also shades soft shapes, whose per-pixel work would slow down every
+// other fragment (the software rasterizers run both sides of a branch)
+#define EFFECT_ATTRIBUTE 1  // Generic attribute location of ColorVertex::effect
+#define EFFECT_PROGRAMS 2   // Plain, soft
+static GLuint effectPrograms[EFFECT_PROGRAMS];
+static bool effectsOn = false;
+static GLint timeUniforms[EFFECT_PROGRAMS];
+static GLint wavesUniforms[EFFECT_PROGRAMS];
+static float effectTime = 0;
+static GLfloat effectWaves[EFFECT_WAVE2 + 1][2];  // Amplitude, rate by effect
+
+// Positions from the fixed-function matrices and colors from glColorPointer,
+// as without the program, plus the effect attribute. A soft shape passes
+// its position scaled so that the fade runs from 0 to 1 over the edge:
+// shape.xy is the position (-1 to 1 at the outline) over the edge width
+// and shape.zw is 1 over the edge width, both as fractions of the half size.
+static const char* effectVertexSource =
+    "#version 120\n"
+    "attribute vec4 effect;\n"
+    "uniform float time;\n"
+    "uniform vec2 waves[4];\n"
+    "varying vec4 color;\n"
+    "varying vec4 shape;\n"
+    "varying float rounded;\n"
+    "void main() {\n"
+    "    gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;\n"
+    "    int kind = int(effect.x * 255.0 + 0.5);\n"
+    "    color = gl_Color;\n"
+    "    shape = vec4(0.0, 0.0, 1.0, 1.0);\n"
+    "    rounded = 0.0;\n"
+    "    if (kind >= 1 && kind <= 3) {\n"
+    "        color.rgb += effect.yzw * waves[kind].x * sin(waves[kind].y * time);\n"
+    "    } else if (kind >= 4) {\n"
+    "        float corner = floor(effect.y * 255.0 + 0.5);\n"
+    "        vec2 p = vec2(mod(corner, 2.0), floor(corner / 2.0)) * 2.0 - 1.0;\n"
+    "        vec2 inverse = 1.0 / max(effect.zw, vec2(1.0 / 255.0));\n"
+    "        shape = vec4(p * inverse, inverse);\n"
+    "        rounded = kind == 4 ? 1.0 : 0.0;\n"
+    "    }\n"
+    "}\n";
+
+static const char* effectFragmentSource =
+    "#version 120\n"
+    "varying vec4 color;\n"
+    "void main() {\n"
+    "    gl_FragColor = color;\n"
+    "}\n";
+
+// Distance inside the outline in edge widths: per axis for a rectangle,
+// radial for an ellipse
+static const char* effectSoftFragmentSource =
+    "#version 120\n"
+    "varying vec4 color;\n"
+    "varying vec4 shape;\n"
+    "varying float rounded;\n"
+    "void main() {\n"
+    "    vec2 inside = shape.zw - abs(shape.xy);\n"
+    "    float edge = mix(min(inside.x, inside.y), shape.z - length(shape.xy), rounded);\n"
+    "    gl_FragColor = vec4(color.rgb, color.a * smoothstep(0.0, 1.0, edge));\n"
+    "}\n";
+
+void renderStatsReset() {
+    renderStats.glCalls = 0;
+    renderStats.drawCalls = 0;
+    renderStats.flushes = 0;
+    renderStats.vertices = 0;
+}
+
+// Make room for count more vertices and return where they go; NULL, with
+// the run unchanged, if it cannot grow (the shape is then dropped)
+static ColorVertex* reserveRun(VertexRun& run, int count) {
+    if (run.count + count > run.capacity) {
+        int capacity = run.capacity ? run.capacity * 2 : 1024;
+        while (capacity < run.count + count) {
+            capacity *= 2;
+        }
+        ColorVertex* vertices = (ColorVertex*)realloc(run.vertices, capacity * sizeof(ColorVertex));
+        if (!vertices) {
+            return NULL;
+        }
+        run.vertices = vertices;
+        run.capacity = capacity;
+    }
+    ColorVertex* out = run.vertices + run.count;
+    run.count += count;
+    return out;
+}
+
+// Start a segment if the vertices added next are drawn by the other
+// effects program, flushing when the run has no segments left
+static void markSegment(VertexRun& run, bool soft) {
+    bool current = run.segmentCount > 0 && run.segmentSoft[run.segmentCount - 1];
+    if (soft == current) {
+        return;
+    }
+    if (run.segmentCount == BATCH_RUN_SEGMENTS) {
+        batchFlush();
+        if (!soft) {
+            return;
+        }
+    }
+    run.segmentStart[run.segmentCount] = run.count;
+    run.segmentSoft[run.segmentCount] = soft;
+    run.segmentCount++;
+}
+
+// Grow bounds to include a point; empty bounds start at the point
+static void includePoint(Bounds& bounds, bool empty, float x, float y) {
+    if (empty || x < bounds.minX) bounds.minX = x;
+    if (empty || x > bounds.maxX) bounds.maxX = x;
+    if (empty || y < bounds.minY) bounds.minY = y;
+    if (empty || y > bounds.maxY) bounds.maxY = y;
+}
+
+// Whether a box touches bounds, allowing a pixel for line width
+static bool overlaps(const Bounds& bounds, float minX, float minY, float maxX, float maxY) {
+    return minX <= bounds.maxX + 1 && maxX >= bounds.minX - 1 &&
+           minY <= bounds.maxY + 1 && maxY >= bounds.minY - 1;
+}
+
+// Flush first if triangles covering this box would be drawn under pending
+// lines or text
+static void checkOverlap(float minX, float minY, float maxX, float maxY) {
+    if ((lines.count > 0 && overlaps(lineBounds, minX, minY, maxX, maxY)) ||
+        (quadCount > 0 && overlaps(quadBounds, minX, minY, maxX, maxY))) {
+        batchFlush();
+    }
+}
+
+// Append triangle vertices that are already in screen space
+static void addTriangles(const ColorVertex* vertices, int count) {
+    if (count == 0) {
+        return;
+    }
+    float minX = vertices[0].x, maxX = vertices[0].x;
+    float minY = vertices[0].y, maxY = vertices[0].y;
+    bool translucent = false, soft = false;
+    for (int i = 0; i < count; i++) {
+        const ColorVertex& v = vertices[i];
+        if (v.x < minX) minX = v.x;
+        if (v.x > maxX) maxX = v.x;
+        if (v.y < minY) minY = v.y;
+        if (v.y > maxY) maxY = v.y;
+        soft = soft || v.effect[0] >= EFFECT_SOFT_ELLIPSE;
+        translucent = translucent || v.a != 255 || soft;
+    }
+    checkOverlap(minX, minY, maxX, maxY);
+    markSegment(triangles, soft);
+
+    ColorVertex* out = reserveRun(triangles, count);
+    if (!out) {
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        out[i] = vertices[i];
+    }
+    triangles.translucent = triangles.translucent || translucent;
+}
+
+// Append one line segment in screen space
+static void addLine(const ColorVertex& from, const ColorVertex& to) {
+    // Lines are drawn before text
+    if (quadCount > 0 &&
+        overlaps(quadBounds, fmin(from.x, to.x), fmin(from.y, to.y),
+                 fmax(from.x, to.x), fmax(from.y, to.y))) {
+        batchFlush();
+    }
+    includePoint(lineBounds, lines.count == 0, from.x, from.y);
+    includePoint(lineBounds, false, to.x, to.y);
+
+    ColorVertex* out = reserveRun(lines, 2);
+    if (!out) {
+        return;
+    }
+    out[0] = from;
+    out[1] = to;
+    lines.translucent = lines.translucent || from.a != 255 || to.a != 255;
+}
+
+void batchBegin(GLenum mode) {
+    primitiveMode = mode;
+    primitiveCount = 0;
+}
+
+void batchColor3f(float r, float g, float b) {
+    batchColor4f(r, g, b, 1.0f);
+}
+
+void batchColor4f(float r, float g, float b, float a) {
+    currentColor[0] = colorToByte(r);
+    currentColor[1] = colorToByte(g);
+    currentColor[2] = colorToByte(b);
+    currentColor[3] = colorToByte(a);
+}
+
+void batchVertex2f(float x, float y) {
+    if (primitiveCount == BATCH_PRIMITIVE_VERTICES) {
+        return;
+    }
+    const BatchMatrix& m = matrixStack[matrixTop];
+    ColorVertex& v = primitive[primitiveCount++];
+    v.x = m.a * x + m.c * y + m.tx;
+    v.y = m.b * x + m.d * y + m.ty;
+    v.r = currentColor[0];
+    v.g = currentColor[1];
+    v.b = currentColor[2];
+    v.a = currentColor[3];
+    memcpy(v.effect, currentEffect, sizeof(v.effect));
+}
+
+void batchEnd() {
+    const ColorVertex* p = primitive;
+    int n = primitiveCount;
+    ColorVertex split[3 * BATCH_PRIMITIVE_VERTICES];
+    int count = 0;
+
+    switch (primitiveMode) {
+        case GL_TRIANGLES:
+            addTriangles(p, n - n % 3);
+            break;
+        case GL_QUADS:
+            // Each quad as two triangles, the same split GL uses
+            for (int i = 0; i + 3 < n; i += 4) {
+                const int corners[6] = {0, 1, 2, 0, 2, 3};
+                for (int k = 0; k < 6; k++) {
+                    split[count++] = p[i + corners[k]];
+                }
+            }
+            addTriangles(split, count);
+            break;
+        case GL_POLYGON:
+            // Convex polygon as a triangle fan
+            for (int i = 1; i + 1 < n; i++) {
+                split[count++] = p[0];
+                split[count++] = p[i];
+                split[count++] = p[i + 1];
+            }
+            addTriangles(split, count);
+            break;
+        case GL_LINES:
+            for (int i = 0; i + 1 < n; i += 2) {
+                addLine(p[i], p[i + 1]);
+            }
+            break;
+        case GL_LINE_STRIP:
+        case GL_LINE_LOOP:
+            for (int i = 0; i + 1 < n; i++) {
+                addLine(p[i], p[i + 1]);
+            }
+            if (primitiveMode == GL_LINE_LOOP && n > 2) {
+                addLine(p[n - 1], p[0]);
+            }
+            break;
+    }
+    primitiveCount = 0;
+}
+
+void batchTriangles(const ColorVertex* vertices, int count) {
+    const BatchMatrix& m = matrixStack[matrixTop];
+    ColorVertex transformed[3 * BATCH_PRIMITIVE_VERTICES];
+    while (count > 0) {
+        int chunk = count < 3 * BATCH_PRIMITIVE_VERTICES ? count : 3 * BATCH_PRIMITIVE_VERTICES;
+        for (int i = 0; i < chunk; i++) {
+            transformed[i] = vertices[i];
+            transformed[i].x = m.a * vertices[i].x + m.c * vertices[i].y + m.tx;
+            transformed[i].y = m.b * vertices[i].x + m.d * vertices[i].y + m.ty;
+        }
+        addTriangles(transformed, chunk);
+        vertices += chunk;
+        count -= chunk;
+    }
+}
+
+void batchTexturedQuad(GLuint texture, float x1, float y1, float x2, float y2,
+                       float u1, float v1, float u2, float v2) {
+    if (quadCount > 0 && texture != quadTexture) {
+        batchFlush();
+    }
+    quadTexture = texture;
+    if (quadCount + 6 > quadCapacity) {
+        int capacity = quadCapacity ? quadCapacity * 2 : 1024;
+        TexVertex* vertices = (TexVertex*)realloc(quadVertices, capacity * sizeof(TexVertex));
+        if (!vertices) {
+            return;  // Dropped, like a shape that does not fit
+        }
+        quadVertices = vertices;
+        quadCapacity = capacity;
+    }
+    includePoint(quadBounds, quadCount == 0, x1, y1);
+    includePoint(quadBounds, false, x2, y2);
+
+    TexVertex* v = quadVertices + quadCount;
+    v[0].x = x1; v[0].y = y1; v[0].u = u1; v[0].v = v1;
+    v[1].x = x2; v[1].y = y1; v[1].u = u2; v[1].v = v1;
+    v[2].x = x2; v[2].y = y2; v[2].u = u2; v[2].v = v2;
+    v[3] = v[0];
+    v[4] = v[2];
+    v[5].x = x1; v[5].y = y2; v[5].u = u1; v[5].v = v2;
+    for (int k = 0; k < 6; k++) {
+        v[k].r = currentColor[0];
+        v[k].g = currentColor[1];
+        v[k].b = currentColor[2];
+        v[k].a = currentColor[3];
+    }
+    quadCount += 6;
+}
+
+void batchPushMatrix() {
+    if (matrixTop + 1 < BATCH_MATRIX_DEPTH) {
+        matrixStack[matrixTop + 1] = matrixStack[matrixTop];
+        matrixTop++;
+    }
+}
+
+void batchPopMatrix() {
+    if (matrixTop > 0) {
+        matrixTop--;
+    }
+}
+
+void batchTranslatef(float x, float y) {
+    BatchMatrix& m = matrixStack[matrixTop];
+    m.tx += m.a * x + m.c * y;
+    m.ty += m.b * x + m.d * y;
+}
+
+void batchRotatef(float degrees) {
+    BatchMatrix& m = matrixStack[matrixTop];
+    float radians = degrees * 3.14159265f / 180.0f;
+    float c = cos(radians), s = sin(radians);
+    BatchMatrix r = m;
+    r.a = m.a * c + m.c * s;
+    r.b = m.b * c + m.d * s;
+    r.c = m.c * c - m.a * s;
+    r.d = m.d * c - m.b * s;
+    m = r;
+}
+
+void batchScalef(float x, float y) {
+    BatchMatrix& m = matrixStack[matrixTop];
+    m.a *= x;
+    m.b *= x;
+    m.c *= y;
+    m.d *= y;
+}
+
+void batchTransformPoint(float x, float y, float& outX, float& outY) {
+    const BatchMatrix& m = matrixStack[matrixTop];
+    outX = m.a * x + m.c * y + m.tx;
+    outY = m.b * x + m.d * y + m.ty;
+}
+
+// Switch to an effects program (0 plain, 1 soft) unless it is current;
+// program is -1 before the first
+static void bindEffectProgram(int wanted, int& program) {
+    if (wanted == program) {
+        return;
+    }
+    if (program < 0) {
+        glEnableVertexAttribArray(EFFECT_ATTRIBUTE);
+        renderStats.glCalls++;
+    }
+    glUseProgram(effectPrograms[wanted]);
+    glUniform1f(timeUniforms[wanted], effectTime);
+    glUniform2fv(wavesUniforms[wanted], EFFECT_WAVE2 + 1, &effectWaves[0][0]);
+    renderStats.glCalls += 3;
+    program = wanted;
+}
+
+// Draw one run, switching blending and effects programs only when their
+// state differs
+static void drawRun(GLenum mode, VertexRun& run, int& blend, int& program) {
+    if (run.count == 0) {
+        return;
+    }
+    int wanted = run.translucent ? 1 : 0;
+    if (wanted != blend) {
+        if (wanted) {
+            glEnable(GL_BLEND);
+            glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+            renderStats.glCalls += 2;
+        } else {
+            glDisable(GL_BLEND);
+            renderStats.glCalls++;
+        }
+        blend = wanted;
+    }
+    glVertexPointer(2, GL_FLOAT, sizeof(ColorVertex), &run.vertices[0].x);
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(ColorVertex), &run.vertices[0].r);
+    renderStats.glCalls += 2;
+    if (effectsOn) {
+        glVertexAttribPointer(EFFECT_ATTRIBUTE, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ColorVertex),
+                              run.vertices[0].effect);
+        renderStats.glCalls++;
+    }
+    // A plain stretch before the first segment, then one draw per segment
+    for (int i = -1; i < run.segmentCount; i++) {
+        int start = i < 0 ? 0 : run.segmentStart[i];
+        int end = i + 1 < run.segmentCount ? run.segmentStart[i + 1] : run.count;
+        if (end == start) {
+            continue;
+        }
+        if (effectsOn) {
+            bindEffectProgram(i < 0 ? 0 : run.segmentSoft[i], program);
+        }
+        glDrawArrays(mode, start, end - start);
+        renderStats.glCalls++;
+        renderStats.drawCalls++;
+    }
+    renderStats.vertices += run.count;
+
+    run.count = 0;
+    run.translucent = false;
+    run.segmentCount = 0;
+}
+
+// Draw the textured quads with blending
+static void drawQuads(int& blend) {
+    if (quadCount == 0) {
+        return;
+    }
+    if (blend != 1) {
+        glEnable(GL_BLEND);
+        glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        renderStats.glCalls += 2;
+        blend = 1;
+    }
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, quadTexture);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(TexVertex), &quadVertices[0].x);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(TexVertex), &quadVertices[0].u);
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(TexVertex), &quadVertices[0].r);
+    glDrawArrays(GL_TRIANGLES, 0, quadCount);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisable(GL_TEXTURE_2D);
+    renderStats.glCalls += 9;
+    renderStats.drawCalls++;
+    renderStats.vertices += quadCount;
+
+    quadCount = 0;
+}
+
+void batchFlush() {
+    if (triangles.count == 0 && lines.count == 0 && quadCount == 0) {
+        return;
+    }
+    int blend = -1;  // unknown
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    renderStats.glCalls += 2;
+
+    int program = -1;  // none
+    drawRun(GL_TRIANGLES, triangles, blend, program);
+    drawRun(GL_LINES, lines, blend, program);
+    if (program >= 0) {
+        glDisableVertexAttribArray(EFFECT_ATTRIBUTE);
+        glUseProgram(0);
+        renderStats.glCalls += 2;
+    }
+    drawQuads(blend);
+
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    renderStats.glCalls += 2;
+    if (blend != 0) {
+        glDisable(GL_BLEND);
+        renderStats.glCalls++;
+    }
+    renderStats.flushes++;
+}
+
+bool batchEffectsInit() {
+    if (effectPrograms[0] == 0) {
+        if (!shaderSupported()) {
+            return false;
+        }
+        const char* attributes[] = {"effect"};
+        const char* fragmentSources[EFFECT_PROGRAMS] = {effectFragmentSource, effectSoftFragmentSource};
+        for (int i = 0; i < EFFECT_PROGRAMS; i++) {
+            effectPrograms[i] = shaderProgram(effectVertexSource, fragmentSources[i], attributes, 1);
+            if (effectPrograms[i] == 0) {
+                batchEffectsFree();
+                return false;
+            }
+            timeUniforms[i] = glGetUniformLocation(effectPrograms[i], "time");
+            wavesUniforms[i] = glGetUniformLocation(effectPrograms[i], "waves");
+        }
+    }
+    effectsOn = true;
+    return true;
+}
+
+void batchEffectsFree() {
+    batchFlush();
+    for (int i = 0; i < EFFECT_PROGRAMS; i++) {
+        if (effectPrograms[i] != 0) {
+            glDeleteProgram(effectPrograms[i]);
+            effectPrograms[i] = 0;
+        }
+    }
+    effectsOn = false;
+}
+
+void batchEffectsEnable(bool enable) {
+    batchFlush();
+    effectsOn = enable && effectPrograms[0] != 0;
+    batchEffect(EFFECT_NONE, 0, 0, 0);
+}
+
+bool batchEffectsActive() {
+    return effectsOn;
+}
+
+void batchEffect(int effect, float r, float g, float b) {
+    if (!effectsOn || effect > EFFECT_WAVE2) {
+        effect = EFFECT_NONE;
+    }
+    currentEffect[0] = (GLubyte)effect;
+    currentEffect[1] = effect ? colorToByte(r) : 0;
+    currentEffect[2] = effect ? colorToByte(g) : 0;
+    currentEffect[3] = effect ? colorToByte(b) : 0;
+}
+
+// One soft shape: a quad whose corners carry their position in the
+// shape and the edge width as fractions of the half size
+static void softQuad(int effect, float x1, float y1, float x2, float y2,
+                     float edgeX, float edgeY) {
+    if (!effectsOn) {
+        return;
+    }
+    GLubyte saved[4];
+    memcpy(saved, currentEffect, sizeof(saved));
+    currentEffect[0] = (GLubyte)effect;
+    currentEffect[2] = edgeX > 1.0f / 255 ? colorToByte(edgeX) : 1;
+    currentEffect[3] = edgeY > 1.0f / 255 ? colorToByte(edgeY) : 1;
+    const int corners[4] = {0, 1, 3, 2};  // Bit 0 right, bit 1 bottom
+    batchBegin(GL_QUADS);
+    for (int k = 0; k < 4; k++) {
+        currentEffect[1] = (GLubyte)corners[k];
+        batchVertex2f(corners[k] & 1 ? x2 : x1, corners[k] & 2 ? y2 : y1);
+    }
+    batchEnd();
+    memcpy(currentEffect, saved, sizeof(saved));
+}
+
+void batchSoftRect(float x1, float y1, float x2, float y2, float edge) {
+    softQuad(EFFECT_SOFT_RECT, x1, y1, x2, y2,
+             edge * 2 / fabs(x2 - x1), edge * 2 / fabs(y2 - y1));
+}
+
+void batchSoftEllipse(float x, float y, float rx, float ry, float edge) {
+    float fraction = edge / (rx < ry ? rx : ry);
+    softQuad(EFFECT_SOFT_ELLIPSE, x - rx, y - ry, x + rx, y + ry, fraction, fraction);
+}
+
+void batchEffectWave(int effect, float amplitude, float rate) {
+    if (effect >= EFFECT_WAVE0 && effect <= EFFECT_WAVE2) {
+        effectWaves[effect][0] = amplitude;
+        effectWaves[effect][1] = rate;
+    }
+}
+
+void batchEffectTime(float seconds) {
+    if (seconds != effectTime) {
+        batchFlush();  // Recorded vertices belong to the old time
+        effectTime = seconds;
+    }
+}
+
+void renderParticles(const ParticlePool& pool, float alpha) {
+    if (pool.count == 0) {
+        return;
+    }
+
+    // Bounds of the biggest glow layer, to order against pending lines
+    float minX = 0, minY = 0, maxX = 0, maxY = 0;
+    for (int i = 0; i < pool.count; i++) {
+        const Particle& p = pool.items[i];
+        float px = p.prevX + (p.x - p.prevX) * alpha;
+        float py = p.prevY + (p.y - p.prevY) * alpha;
+        float extent = p.size * p.life + 4;
+        if (i == 0 || px - extent < minX) minX = px - extent;
+        if (i == 0 || px + extent > maxX) maxX = px + extent;
+        if (i == 0 || py - extent < minY) minY = py - extent;
+        if (i == 0 || py + extent > maxY) maxY = py + extent;
+    }
+    checkOverlap(minX, minY, maxX, maxY);
+    markSegment(triangles, false);
+
+    // 3 glow quads of 2 triangles per particle
+    ColorVertex* v = reserveRun(triangles, pool.count * 18);
+    if (!v) {
+        return;
+    }
+    for (int i = 0; i < pool.count; i++) {
+        const Particle& p = pool.items[i];
+        float life = p.life;
+        float size = p.size * life;
+        float px = p.prevX + (p.x - p.prevX) * alpha;
+        float py = p.prevY + (p.y - p.prevY) * alpha;
+        GLubyte r = colorToByte(p.r), g = colorToByte(p.g), b = colorToByte(p.b);
+
+        // Glow effect: widening, fading layers
+        for (int j = 0; j < 3; j++) {
+            GLubyte a = colorToByte(life * (0.3f - j * 0.1f));
+            float glowSize = size + j * 2;
+            float x1 = px - glowSize, x2 = px + glowSize;
+            float y1 = py - glowSize, y2 = py + glowSize;
+            v[0].x = x1; v[0].y = y1;
+            v[1].x = x2; v[1].y = y1;
+            v[2].x = x2; v[2].y = y2;
+            v[3].x = x1; v[3].y = y1;
+            v[4].x = x2; v[4].y = y2;
+            v[5].x = x1; v[5].y = y2;
+            for (int k = 0; k < 6; k++) {
+                v[k].r = r; v[k].g = g; v[k].b = b; v[k].a = a;
+                memset(v[k].effect, 0, sizeof(v[k].effect));
+            }
+            v += 6;
+        }
+    }
+    triangles.translucent = true;
+}
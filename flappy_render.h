@@ -0,0 +1,138 @@
+// Batched rendering helpers
+// Geometry is built on the CPU into client-side vertex arrays and submitted
+// in a few draw calls instead of a glBegin/glEnd pair per shape.
+//
+// Draw code records shapes with batchBegin()/batchVertex2f()/batchEnd(),
+// which mirror immediate mode, or appends prebuilt vertices with
+// batchTriangles(). Quads and polygons become triangles and strips/loops
+// become line segments, so a batch holds only three runs, drawn triangles
+// first, lines second and textured quads (text) last. Anything that would
+// cover pending lines or text flushes the batch first, so the picture
+// matches submission order.
+// Blending is turned on for a run only when it contains a translucent
+// vertex; opaque vertices blend to exactly their own color. Alpha is
+// accumulated as coverage (source over), so batches drawn into a cleared
+// texture (flappy_layer.h) keep the right transparency.
+#ifndef FLAPPY_RENDER_H
+#define FLAPPY_RENDER_H
+
+#include "flappy_gl.h"
+#include "flappy_particles.h"
+
+// Vertex with 8-bit color, as uploaded with glVertexPointer/glColorPointer
+struct ColorVertex {
+    GLfloat x, y;
+    GLubyte r, g, b, a;
+    GLubyte effect[4];  // BatchEffect and its three parameters; 0 for plain color
+};
+
+// Vertex of a textured quad, e.g. a glyph from the text atlas
+struct TexVertex {
+    GLfloat x, y;
+    GLfloat u, v;
+    GLubyte r, g, b, a;
+};
+
+// Convert a color channel to 8 bits, clamped like glColor3f
+static inline GLubyte colorToByte(float c) {
+    if (c <= 0.0f) return 0;
+    if (c >= 1.0f) return 255;
+    return (GLubyte)(c * 255.0f + 0.5f);
+}
+
+// Per-frame renderer counters
+struct RenderStats {
+    int glCalls;    // GL entry points called
+    int drawCalls;  // glDrawArrays calls
+    int flushes;    // batches submitted
+    int vertices;   // vertices submitted
+};
+
+extern RenderStats renderStats;
+
+// Clear the counters, once per frame
+void renderStatsReset();
+
+// Record one primitive: GL_TRIANGLES, GL_QUADS, GL_POLYGON, GL_LINES,
+// GL_LINE_STRIP or GL_LINE_LOOP
+void batchBegin(GLenum mode);
+void batchColor3f(float r, float g, float b);
+void batchColor4f(float r, float g, float b, float a);
+void batchVertex2f(float x, float y);
+void batchEnd();
+
+// Append a prebuilt triangle list, transformed by the current matrix
+void batchTriangles(const ColorVertex* vertices, int count);
+
+// Append a quad from texture (modulated by the current color, alpha
+// blended) in screen coordinates; the batch holds one texture at a time
+void batchTexturedQuad(GLuint texture, float x1, float y1, float x2, float y2,
+                       float u1, float v1, float u2, float v2);
+
+// 2D transform applied to recorded vertices, like the modelview stack
+void batchPushMatrix();
+void batchPopMatrix();
+void batchTranslatef(float x, float y);
+void batchRotatef(float degrees);
+void batchScalef(float x, float y);
+
+// Map a point through the current transform to screen coordinates
+void batchTransformPoint(float x, float y, float& outX, float& outY);
+
+// Draw everything recorded so far. Leaves GL_BLEND disabled; call before
+// drawing anything outside the batch.
+void batchFlush();
+
+// Shader effects
+// With batchEffectsInit(), triangles and lines are drawn by GLSL 1.20
+// programs that apply each vertex's effect from a time uniform, so what
+// moves with time costs no per-frame vertex work and a soft shadow is one
+// quad:
+//   EFFECT_WAVE0..2    color += weights * amplitude * sin(rate * time),
+//                      with the weights from batchEffect() (0 to 1) and
+//                      amplitude and rate from batchEffectWave(); for
+//                      gradient color shifts and pulses
+//   EFFECT_SOFT_ELLIPSE, EFFECT_SOFT_RECT
+//                      batchSoftEllipse() and batchSoftRect(): alpha fades
+//                      to 0 at the outline over an edge width
+// Without shader support the effects are off and vertices draw their plain
+// color; callers check batchEffectsActive() and record the fixed-function
+// version of the effect instead.
+enum BatchEffect {
+    EFFECT_NONE,
+    EFFECT_WAVE0,
+    EFFECT_WAVE1,
+    EFFECT_WAVE2,
+    EFFECT_SOFT_ELLIPSE,
+    EFFECT_SOFT_RECT
+};
+
+// Build the programs in the current context; false if shaders are not
+// supported. Effects are then on.
+bool batchEffectsInit();
+void batchEffectsFree();
+
+// Turn built effects on or off, e.g. to compare with the fixed-function
+// path; takes effect for vertices recorded from now on
+void batchEffectsEnable(bool enable);
+bool batchEffectsActive();
+
+// Wave effect and weights of the vertices recorded next (EFFECT_NONE to
+// stop); ignored while effects are off
+void batchEffect(int effect, float r, float g, float b);
+
+// Shape of a wave effect, and the time (seconds) of the frame being drawn
+void batchEffectWave(int effect, float amplitude, float rate);
+void batchEffectTime(float seconds);
+
+// Soft shapes in the current color and transform, fading out over edge
+// units inside the outline; nothing is recorded while effects are off
+void batchSoftRect(float x1, float y1, float x2, float y2, float edge);
+void batchSoftEllipse(float x, float y, float rx, float ry, float edge);
+
+// Add every live particle, with its three glow layers, to the batch in
+// screen coordinates. alpha interpolates between the previous and current
+// tick positions.
+void renderParticles(const ParticlePool& pool, float alpha);
+
+#endif
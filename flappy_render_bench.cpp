@@ -0,0 +1,172 @@
+// Render benchmark (offscreen, e.g. Mesa llvmpipe)
+// Compares the per-particle glBegin/glEnd particle drawing with the single
+// vertex-array draw of renderParticles() at increasing particle counts, and
+// per-character glBitmap text with the glyph-atlas text batch on a screen
+// full of text.
+//
+// Usage: flappy_render_bench [frames]
+#include <stdio.h>
+#include <stdlib.h>
+#include "flappy_sim.h"
+#include "flappy_particles.h"
+#include "flappy_render.h"
+#include "flappy_text.h"
+#include "flappy_offscreen.h"
+#include "flappy_time.h"
+
+// Previous drawParticles(): three immediate-mode quads per particle
+static void drawParticlesImmediate(const ParticlePool& pool) {
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    for (int i = 0; i < pool.count; i++) {
+        const Particle& p = pool.items[i];
+        float alpha = p.life;
+        float size = p.size * alpha;
+        for (int j = 0; j < 3; j++) {
+            float glowAlpha = alpha * (0.3f - j * 0.1f);
+            float glowSize = size + j * 2;
+            glColor4f(p.r, p.g, p.b, glowAlpha);
+            glBegin(GL_QUADS);
+            glVertex2f(p.x - glowSize, p.y - glowSize);
+            glVertex2f(p.x + glowSize, p.y - glowSize);
+            glVertex2f(p.x + glowSize, p.y + glowSize);
+            glVertex2f(p.x - glowSize, p.y + glowSize);
+            glEnd();
+        }
+    }
+    glDisable(GL_BLEND);
+}
+
+// Spread count particles over the screen at various ages
+static void fillPool(ParticlePool& pool, int count) {
+    particlesClear(pool);
+    for (int i = 0; i < count; i++) {
+        Particle* p = particlesEmit(pool, rand() % WINDOW_WIDTH, rand() % WINDOW_HEIGHT,
+                                    1.0f, 1.0f, 0.8f);
+        p->life = 0.2f + (rand() % 80) / 100.0f;
+    }
+}
+
+// Average submit time (CPU time in the draw call) and total frame time
+static void timeFrames(const ParticlePool& pool, int frames, bool batched,
+                       double& submit, double& total) {
+    submit = 0;
+    total = 0;
+    for (int f = -2; f < frames; f++) {  // two warmup frames
+        glClear(GL_COLOR_BUFFER_BIT);
+        glFinish();
+        double start = timeNow();
+        if (batched) {
+            renderParticles(pool, 1.0f);
+            batchFlush();
+        } else {
+            drawParticlesImmediate(pool);
+        }
+        double submitted = timeNow();
+        glFinish();
+        double end = timeNow();
+        if (f >= 0) {
+            submit += submitted - start;
+            total += end - start;
+        }
+    }
+    submit /= frames;
+    total /= frames;
+}
+
+#define BENCH_TEXT_LINES 36
+#define BENCH_TEXT_COLUMNS 72
+
+// A screen of bold text (shadow + main, like renderText()) per frame
+static void drawTextScreen(const char lines[][BENCH_TEXT_COLUMNS + 1], bool batched) {
+    for (int i = 0; i < BENCH_TEXT_LINES; i++) {
+        float x = 10, y = 16 + i * 16;
+        if (batched) {
+            batchColor3f(0.0f, 0.0f, 0.0f);
+            batchText(x + 2, y - 2, lines[i]);
+            batchColor3f(1.0f, 1.0f, 1.0f);
+            batchText(x, y, lines[i]);
+        } else {
+            glColor3f(0.0f, 0.0f, 0.0f);
+            glRasterPos2f(x + 2, y - 2);
+            for (const char* c = lines[i]; *c != '\0'; c++) {
+                offscreenDrawGlyph(*c);
+            }
+            glColor3f(1.0f, 1.0f, 1.0f);
+            glRasterPos2f(x, y);
+            for (const char* c = lines[i]; *c != '\0'; c++) {
+                offscreenDrawGlyph(*c);
+            }
+        }
+    }
+    if (batched) {
+        batchFlush();
+    }
+}
+
+static void benchText(int frames) {
+    glClear(GL_COLOR_BUFFER_BIT);
+    textAtlasBuild(offscreenDrawGlyph, offscreenGlyphAdvance);
+
+    static char lines[BENCH_TEXT_LINES][BENCH_TEXT_COLUMNS + 1];
+    for (int i = 0; i < BENCH_TEXT_LINES; i++) {
+        for (int j = 0; j < BENCH_TEXT_COLUMNS; j++) {
+            lines[i][j] = TEXT_FIRST_CHAR + (i * 7 + j * 13) % (TEXT_LAST_CHAR - TEXT_FIRST_CHAR + 1);
+        }
+        lines[i][BENCH_TEXT_COLUMNS] = '\0';
+    }
+
+    for (int batched = 0; batched < 2; batched++) {
+        double submit = 0, total = 0;
+        for (int f = -2; f < frames; f++) {  // two warmup frames
+            glClear(GL_COLOR_BUFFER_BIT);
+            glFinish();
+            double start = timeNow();
+            drawTextScreen(lines, batched != 0);
+            double submitted = timeNow();
+            glFinish();
+            double end = timeNow();
+            if (f >= 0) {
+                submit += submitted - start;
+                total += end - start;
+            }
+        }
+        printf("  %-12s  %6d glyphs  submit %8.2f ms  frame %8.2f ms\n",
+               batched ? "glyph atlas" : "glBitmap", 2 * BENCH_TEXT_LINES * BENCH_TEXT_COLUMNS,
+               submit / frames * 1000, total / frames * 1000);
+    }
+    textAtlasFree();
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 20;
+    if (!offscreenInit(WINDOW_WIDTH, WINDOW_HEIGHT)) {
+        return 1;
+    }
+    printf("renderer: %s\n", offscreenRenderer());
+
+    const int counts[] = {1000, 10000, 100000};
+    ParticlePool pool;
+    particlesInit(pool, counts[2]);
+    srand(1);
+
+    for (int i = 0; i < 3; i++) {
+        fillPool(pool, counts[i]);
+        double immediateSubmit, immediateTotal, batchedSubmit, batchedTotal;
+        timeFrames(pool, frames, false, immediateSubmit, immediateTotal);
+        timeFrames(pool, frames, true, batchedSubmit, batchedTotal);
+        printf("particles %6d\n", counts[i]);
+        printf("  immediate     %6d draws  submit %8.2f ms  frame %8.2f ms\n",
+               counts[i] * 3, immediateSubmit * 1000, immediateTotal * 1000);
+        printf("  vertex array  %6d draw   submit %8.2f ms  frame %8.2f ms\n",
+               1, batchedSubmit * 1000, batchedTotal * 1000);
+    }
+
+    particlesFree(pool);
+
+    printf("text (%d lines of %d bold characters)\n", BENCH_TEXT_LINES, BENCH_TEXT_COLUMNS);
+    benchText(frames);
+
+    offscreenShutdown();
+    return 0;
+}
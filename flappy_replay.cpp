@@ -0,0 +1,201 @@
+#include "flappy_replay.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char replayMagic[4] = {'F', 'B', 'R', 'P'};
+
+// Varints besides the flap deltas: seed, pipe count, pipe spacing, swept
+// collision, level checksum, flap count, death tick, score. Keep in step
+// with replaySave() when the layout changes.
+#define REPLAY_FIXED_VARINTS 8
+
+void replayInit(Replay& replay, unsigned int seed) {
+    replay.seed = seed;
+    replay.pipeCount = MAX_PIPES;
+    replay.pipeSpacing = PIPE_SPACING;
+    replay.sweptCollision = false;
+    replay.levelChecksum = 0;
+    replay.flaps = NULL;
+    replay.flapCount = 0;
+    replay.flapCapacity = 0;
+    replay.deathTick = 0;
+    replay.score = 0;
+}
+
+void replayFree(Replay& replay) {
+    free(replay.flaps);
+    replayInit(replay, 0);
+}
+
+void replayAddFlap(Replay& replay, unsigned int tick) {
+    if (replay.flapCount == replay.flapCapacity) {
+        int capacity = replay.flapCapacity ? replay.flapCapacity * 2 : 256;
+        unsigned int* flaps = (unsigned int*)realloc(replay.flaps, capacity * sizeof(unsigned int));
+        if (!flaps) {
+            return;
+        }
+        replay.flaps = flaps;
+        replay.flapCapacity = capacity;
+    }
+    replay.flaps[replay.flapCount++] = tick;
+}
+
+void replayFinish(Replay& replay, const SimState& state) {
+    replay.deathTick = state.tick;
+    replay.score = state.score;
+}
+
+bool replayFlapAt(const Replay& replay, int& cursor, unsigned int tick) {
+    while (cursor < replay.flapCount && replay.flaps[cursor] < tick) {
+        cursor++;
+    }
+    if (cursor < replay.flapCount && replay.flaps[cursor] == tick) {
+        cursor++;
+        return true;
+    }
+    return false;
+}
+
+// LEB128: 7 bits per byte, low bits first, high bit set on all but the last
+static unsigned char* writeVarint(unsigned char* out, unsigned int value) {
+    while (value >= 0x80) {
+        *out++ = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (unsigned char)value;
+    return out;
+}
+
+static bool readVarint(const unsigned char*& in, const unsigned char* end, unsigned int& value) {
+    value = 0;
+    for (int shift = 0; shift < 35 && in < end; shift += 7) {
+        unsigned char byte = *in++;
+        value |= (unsigned int)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool replaySave(const Replay& replay, const char* path) {
+    // At most 5 bytes per varint
+    int size = sizeof(replayMagic) + 1 + (replay.flapCount + REPLAY_FIXED_VARINTS) * 5;
+    unsigned char* data = (unsigned char*)malloc(size);
+    if (!data) {
+        return false;
+    }
+
+    unsigned char* out = data;
+    memcpy(out, replayMagic, sizeof(replayMagic));
+    out += sizeof(replayMagic);
+    *out++ = REPLAY_VERSION;
+    out = writeVarint(out, replay.seed);
+    out = writeVarint(out, replay.pipeCount);
+    out = writeVarint(out, replay.pipeSpacing);
+    out = writeVarint(out, replay.sweptCollision ? 1 : 0);
+    out = writeVarint(out, replay.levelChecksum);
+    out = writeVarint(out, replay.flapCount);
+    unsigned int previous = 0;
+    for (int i = 0; i < replay.flapCount; i++) {
+        out = writeVarint(out, replay.flaps[i] - previous);
+        previous = replay.flaps[i];
+    }
+    out = writeVarint(out, replay.deathTick);
+    out = writeVarint(out, replay.score);
+
+    FILE* f = fopen(path, "wb");
+    bool ok = f && fwrite(data, 1, out - data, f) == (size_t)(out - data);
+    if (f && fclose(f) != 0) {
+        ok = false;
+    }
+    free(data);
+    return ok;
+}
+
+bool replayLoad(Replay& replay, const char* path) {
+    replayInit(replay, 0);
+
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size < (long)sizeof(replayMagic) + 1) {
+        fclose(f);
+        return false;
+    }
+    unsigned char* data = (unsigned char*)malloc(size);
+    bool ok = data && fread(data, 1, size, f) == (size_t)size;
+    fclose(f);
+
+    const unsigned char* in = data;
+    const unsigned char* end = data + size;
+    unsigned int pipeCount = 0, pipeSpacing = 0, swept = 0, flapCount = 0, score = 0;
+    ok = ok && memcmp(in, replayMagic, sizeof(replayMagic)) == 0 &&
+         in[sizeof(replayMagic)] == REPLAY_VERSION;
+    if (ok) {
+        in += sizeof(replayMagic) + 1;
+        ok = readVarint(in, end, replay.seed) &&
+             readVarint(in, end, pipeCount) && readVarint(in, end, pipeSpacing) &&
+             pipeCount >= 1 && pipeCount <= SIM_PIPE_CAPACITY &&
+             pipeSpacing >= 1 && pipeSpacing <= SIM_MAX_PIPE_SPACING &&
+             readVarint(in, end, swept) && swept <= 1 &&
+             readVarint(in, end, replay.levelChecksum) &&
+             readVarint(in, end, flapCount) &&
+             flapCount <= (unsigned int)(end - in);  // At least a byte per flap
+        replay.pipeCount = (int)pipeCount;
+        replay.pipeSpacing = (int)pipeSpacing;
+        replay.sweptCollision = swept != 0;
+    }
+
+    unsigned int tick = 0;
+    for (unsigned int i = 0; ok && i < flapCount; i++) {
+        unsigned int delta;
+        ok = readVarint(in, end, delta) && (i == 0 || delta > 0);
+        tick += delta;
+        replayAddFlap(replay, tick);
+    }
+    ok = ok && replay.flapCount == (int)flapCount &&
+         readVarint(in, end, replay.deathTick) && readVarint(in, end, score) && in == end;
+    replay.score = (int)score;
+    free(data);
+
+    if (!ok) {
+        replayFree(replay);
+    }
+    return ok;
+}
+
+ReplayResult replayRun(const Replay& replay, const LevelFile* level) {
+    SimState state;
+    simInit(state, replay.seed);
+    simSetLevel(state, replay.pipeCount, replay.pipeSpacing);
+    simSetLevelFile(state, replay.levelChecksum ? level : NULL);
+    simSetSweptCollision(state, replay.sweptCollision);
+    simRestart(state, replay.seed);
+
+    int cursor = 0;
+    while (!state.dead && state.tick <= replay.deathTick) {
+        SimInput input = { replayFlapAt(replay, cursor, state.tick) };
+        simStep(state, input);
+    }
+
+    ReplayResult result = { state.dead, state.tick, state.score };
+    return result;
+}
+
+bool replayVerify(const Replay& replay, const LevelFile* level, ReplayResult& result) {
+    if (replay.levelChecksum != 0 &&
+        (!level || level->header->dataChecksum != replay.levelChecksum)) {
+        result.died = false;
+        result.deathTick = 0;
+        result.score = 0;
+        return false;
+    }
+    result = replayRun(replay, level);
+    return result.died && result.deathTick == replay.deathTick && result.score == replay.score;
+}
@@ -0,0 +1,70 @@
+// Input replays
+// A run is recorded as its level seed plus the ticks on which the bird
+// flapped; since the simulation is deterministic, that reproduces the
+// whole run. Files hold the ticks as LEB128 varint deltas, so a typical
+// run takes a few hundred bytes, and are verified by stepping the
+// simulation headlessly against the recorded score and death tick.
+//
+// File layout: "FBRP", version byte, then varints: seed, pipe count, pipe
+// spacing, swept collision (0 or 1), level file checksum (0 for none),
+// flap count, flap tick deltas (the first one from tick 0), death tick,
+// score.
+#ifndef FLAPPY_REPLAY_H
+#define FLAPPY_REPLAY_H
+
+#include "flappy_sim.h"
+#include "flappy_level.h"
+
+#define REPLAY_VERSION 4
+
+struct Replay {
+    unsigned int seed;       // simRestart() seed of the run
+    int pipeCount;           // Level shape, see simSetLevel()
+    int pipeSpacing;
+    bool sweptCollision;     // simSetSweptCollision()
+    unsigned int levelChecksum;  // Level file's data checksum, 0 for none
+    unsigned int* flaps;     // SimState::tick of each flapping step, ascending
+    int flapCount;
+    int flapCapacity;
+    unsigned int deathTick;  // SimState::tick after the step that died
+    int score;
+};
+
+// Outcome of a headless run
+struct ReplayResult {
+    bool died;
+    unsigned int deathTick;
+    int score;
+};
+
+// Empty replay of the default level
+void replayInit(Replay& replay, unsigned int seed);
+void replayFree(Replay& replay);
+
+// Record a flap applied on the step that starts at tick
+void replayAddFlap(Replay& replay, unsigned int tick);
+
+// Record the end of the run from the state after the fatal step
+void replayFinish(Replay& replay, const SimState& state);
+
+// Whether the step starting at tick flaps; cursor (0 at the start of the
+// run) remembers the position, so a run costs O(flaps) in total
+bool replayFlapAt(const Replay& replay, int& cursor, unsigned int tick);
+
+bool replaySave(const Replay& replay, const char* path);
+
+// Read a replay file into replay (initialized or not); false if the file is
+// missing, truncated or not a replay
+bool replayLoad(Replay& replay, const char* path);
+
+// Step the recorded level and seed with the recorded flaps until the bird dies or the
+// recorded death tick has passed. A replay of a level file runs on level,
+// which must be that file.
+ReplayResult replayRun(const Replay& replay, const LevelFile* level);
+
+// replayRun() and compare with the recorded death tick and score; false
+// without running if the replay was played on a level file other than
+// level. Replays of generated levels ignore level.
+bool replayVerify(const Replay& replay, const LevelFile* level, ReplayResult& result);
+
+#endif
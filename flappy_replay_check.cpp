@@ -0,0 +1,208 @@
+// Headless replay checker
+// Plays replay files through the simulation core as fast as it can step
+// and checks each against its recorded score and death tick. Directories
+// are read for *.replay files. --generate records a corpus of bot runs,
+// e.g. as a regression corpus or benchmark workload. --ghosts records bot
+// runs of one level as a ghost file for racing (flappy_ghost.h). With
+// --level first, runs and ghosts are generated on, and runs checked
+// against, a level file (flappy_level.h).
+//
+// Usage: flappy_replay_check [--level FILE] FILE|DIR...
+//        flappy_replay_check [--level FILE] --generate DIR [count] [first seed]
+//        flappy_replay_check [--level FILE] --ghosts FILE [count] [seed]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "flappy_sim.h"
+#include "flappy_replay.h"
+#include "flappy_ghost.h"
+#include "flappy_level.h"
+#include "flappy_time.h"
+
+// Give up on runs the bot never loses, and on levels where it loses too
+// few: at most this many seeds are tried per replay asked for
+#define GENERATE_MAX_TICKS 200000
+#define GENERATE_SEEDS_PER_REPLAY 10
+
+// --level: the level file of generated and checked runs, or NULL
+LevelFile levelFile;
+const LevelFile* level = NULL;
+
+// Scripted bot: flap when falling below the centre of the next gap, with a
+// per-seed target offset so the runs end in different ways
+static bool botWantsFlap(const SimState& state, int offset) {
+    const Pipe* next = simNextPipe(state);
+    float targetY = next ? next->gapY + offset : WINDOW_HEIGHT / 2;
+    return state.birdY > targetY && state.birdVelocity >= 0;
+}
+
+static int generate(const char* dir, int count, unsigned int firstSeed) {
+    mkdir(dir, 0755);
+    Replay replay;
+    replayInit(replay, 0);
+    replay.levelChecksum = level ? level->header->dataChecksum : 0;
+    long ticks = 0;
+    int written = 0;
+    int capped = 0;
+    long maxSeeds = (long)count * GENERATE_SEEDS_PER_REPLAY;
+    for (long tried = 0; written < count && tried < maxSeeds; tried++) {
+        unsigned int seed = firstSeed + (unsigned int)tried;
+        SimState state;
+        simInit(state, seed);
+        simSetLevelFile(state, level);
+        simRestart(state, seed);
+        replay.seed = seed;
+        replay.flapCount = 0;
+        int offset = (int)(seed % 41) - 10;
+        while (!state.dead && state.tick < GENERATE_MAX_TICKS) {
+            SimInput input = { botWantsFlap(state, offset) };
+            if (input.flap) {
+                replayAddFlap(replay, state.tick);
+            }
+            simStep(state, input);
+        }
+        if (!state.dead) {
+            capped++;
+            continue;
+        }
+        replayFinish(replay, state);
+
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/run_%u.replay", dir, seed);
+        if (!replaySave(replay, path)) {
+            fprintf(stderr, "cannot write %s\n", path);
+            replayFree(replay);
+            return 1;
+        }
+        ticks += state.tick;
+        written++;
+    }
+    replayFree(replay);
+    printf("wrote %d replays (%ld ticks) to %s\n", written, ticks, dir);
+    if (written < count) {
+        printf("%d short: %d runs outlived %d ticks\n", count - written, capped,
+               GENERATE_MAX_TICKS);
+        return 1;
+    }
+    return 0;
+}
+
+static int generateGhosts(const char* path, int count, unsigned int seed) {
+    GhostSet set;
+    ghostInit(set, seed);
+    set.levelChecksum = level ? level->header->dataChecksum : 0;
+    double start = timeNow();
+    long ticks = ghostRecordBots(set, count, seed, level);
+    double elapsed = timeNow() - start;
+    bool ok = ghostSave(set, path);
+    if (ok) {
+        printf("wrote %d ghosts (%ld ticks, %.1f KB) of seed %u to %s in %.2f s\n", set.runCount,
+               ticks, ticks * sizeof(short) / 1024.0, seed, path, elapsed);
+    } else {
+        fprintf(stderr, "cannot write %s\n", path);
+    }
+    ghostFree(set);
+    return ok ? 0 : 1;
+}
+
+struct CheckTotals {
+    int files;
+    int failed;
+    long ticks;
+    double stepTime;
+};
+
+static void checkFile(const char* path, CheckTotals& totals) {
+    Replay replay;
+    totals.files++;
+    if (!replayLoad(replay, path)) {
+        printf("%s: not a replay\n", path);
+        totals.failed++;
+        return;
+    }
+
+    if (replay.levelChecksum != 0 &&
+        (!level || level->header->dataChecksum != replay.levelChecksum)) {
+        printf("%s: played on level file %08x, not the --level one\n", path, replay.levelChecksum);
+        totals.failed++;
+        replayFree(replay);
+        return;
+    }
+
+    ReplayResult result;
+    double start = timeNow();
+    bool ok = replayVerify(replay, level, result);
+    totals.stepTime += timeNow() - start;
+    totals.ticks += result.deathTick;
+
+    if (!ok) {
+        printf("%s: MISMATCH  seed %u  recorded score %d death tick %u  got score %d %s tick %u\n",
+               path, replay.seed, replay.score, replay.deathTick, result.score,
+               result.died ? "death" : "alive at", result.deathTick);
+        totals.failed++;
+    }
+    replayFree(replay);
+}
+
+static void checkPath(const char* path, CheckTotals& totals) {
+    DIR* dir = opendir(path);
+    if (!dir) {
+        checkFile(path, totals);
+        return;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        int length = strlen(entry->d_name);
+        if (length > 7 && strcmp(entry->d_name + length - 7, ".replay") == 0) {
+            char file[1024];
+            snprintf(file, sizeof(file), "%s/%s", path, entry->d_name);
+            checkFile(file, totals);
+        }
+    }
+    closedir(dir);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 2 && strcmp(argv[1], "--level") == 0) {
+        if (!levelOpen(levelFile, argv[2]) || !levelVerify(levelFile)) {
+            printf("cannot read level %s\n", argv[2]);
+            return 1;
+        }
+        level = &levelFile;
+        argv[2] = argv[0];
+        argv += 2;
+        argc -= 2;
+    }
+    if (argc > 2 && strcmp(argv[1], "--generate") == 0) {
+        int count = argc > 3 ? atoi(argv[3]) : 1000;
+        unsigned int firstSeed = argc > 4 ? strtoul(argv[4], NULL, 10) : 1;
+        return generate(argv[2], count, firstSeed);
+    }
+    if (argc > 2 && strcmp(argv[1], "--ghosts") == 0) {
+        int count = argc > 3 ? atoi(argv[3]) : 10000;
+        unsigned int seed = argc > 4 ? strtoul(argv[4], NULL, 10) : 1;
+        return generateGhosts(argv[2], count, seed);
+    }
+    if (argc < 2) {
+        printf("usage: flappy_replay_check [--level FILE] FILE|DIR...\n"
+               "       flappy_replay_check [--level FILE] --generate DIR [count] [first seed]\n"
+               "       flappy_replay_check [--level FILE] --ghosts FILE [count] [seed]\n");
+        return 1;
+    }
+
+    CheckTotals totals = {0, 0, 0, 0};
+    double start = timeNow();
+    for (int i = 1; i < argc; i++) {
+        checkPath(argv[i], totals);
+    }
+    double elapsed = timeNow() - start;
+
+    printf("replays:      %d (%d failed)\n", totals.files, totals.failed);
+    printf("ticks:        %ld (%.1f min of play)\n", totals.ticks, totals.ticks * SIM_DT / 60);
+    printf("elapsed:      %.3f s (%.3f s stepping)\n", elapsed, totals.stepTime);
+    if (elapsed > 0) {
+        printf("speed:        %.0fx real time\n", totals.ticks * SIM_DT / elapsed);
+    }
+    return totals.failed ? 1 : 0;
+}
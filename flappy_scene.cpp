@@ -0,0 +1,1403 @@
+#include "flappy_scene.h"
+#include "flappy_render.h"
+#include "flappy_text.h"
+#include "flappy_layer.h"
+#include "flappy_profile.h"
+#include "flappy_replay.h"
+#include "flappy_ghost.h"
+#include "flappy_level.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+// Draw functions
+void renderText(float x, float y, const char* text, GLfloat* color, bool isBold = false, float scale = 1.0f);
+void drawCloudTexture();
+void drawGhostPoses();
+void measureGhostPoses();
+void drawGroundTile();
+
+//colors
+// Enhanced color definitions with gradients
+typedef struct {
+    GLfloat top[3];
+    GLfloat bottom[3];
+} GradientColor;
+
+// Sky gradient (sunset-like colors)
+GradientColor skyGradient = {
+    .top = {0.529f, 0.808f, 0.922f},    // Light blue
+    .bottom = {0.941f, 0.862f, 0.510f}   // Light golden
+};
+
+// Ground gradient (rich earth tones)
+GradientColor groundGradient = {
+    .top = {0.545f, 0.371f, 0.153f},     // Brown
+    .bottom = {0.373f, 0.247f, 0.088f}   // Dark brown
+};
+
+// Bird colors (more vibrant yellow with orange gradient)
+GradientColor birdGradient = {
+    .top = {1.0f, 0.894f, 0.109f},       // Bright yellow
+    .bottom = {0.999f, 0.659f, 0.031f}   // Golden orange
+};
+
+// Pipe colors (realistic green with darker gradient)
+GradientColor pipeGradient = {
+    .top = {0.180f, 0.832f, 0.372f},     // Bright green
+    .bottom = {0.180f, 0.649f, 0.372f}   // Dark green
+};
+
+// Cloud colors
+GLfloat cloudColor[] = {1.0f, 1.0f, 1.0f};
+GLfloat cloudShadowColor[] = {0.95f, 0.95f, 0.95f};
+
+// Color shifts over time: the gradient colors plus amplitude * sin(rate *
+// seconds) times the weights at each end. With shader effects the shift
+// is applied per vertex on the GPU (see batchEffect()).
+#define SKY_SHIFT_AMPLITUDE 0.1f
+#define SKY_SHIFT_RATE 0.5f
+#define GROUND_SHIFT_AMPLITUDE 0.05f
+#define GROUND_SHIFT_RATE 0.3f
+#define BIRD_PULSE_AMPLITUDE 0.1f  // Weighted by the gradient top
+#define BIRD_PULSE_RATE 5.0f
+GLfloat skyShiftTop[] = {1.0f, 0.5f, 0.2f};
+GLfloat skyShiftBottom[] = {0.5f, 0.3f, 0.1f};
+GLfloat groundShiftTop[] = {1.0f, 0.5f, 0.3f};
+GLfloat groundShiftBottom[] = {0.5f, 0.3f, 0.2f};
+
+// Soft shadows with shader effects: one quad each, covering what the
+// fixed-function layers cover, with their stacked opacity
+#define BIRD_SHADOW_ALPHA 0.196f   // 1 - 0.9 * 0.93 * 0.96
+#define BIRD_SHADOW_EDGE 4.0f      // Fade width, pixels
+#define PIPE_SHADOW_ALPHA 0.273f   // 1 - 0.85 * 0.9 * 0.95
+#define PIPE_SHADOW_SPREAD 4.0f    // Past the pipe, right and down
+#define PIPE_SHADOW_EDGE 8.0f
+
+// Shadow properties
+#define SHADOW_OFFSET_X 5.0f
+#define SHADOW_OFFSET_Y 5.0f
+#define SHADOW_ALPHA 0.3f
+
+// Cached geometry
+// Circles are tessellated once at startup into triangle vertex arrays.
+// Per frame only the transform and the animated colors change.
+#define CIRCLE_SEGMENTS 10  // One vertex every 36 degrees
+#define CIRCLE_VERTICES ((CIRCLE_SEGMENTS - 2) * 3)  // As a triangle fan
+#define CLOUD_COUNT 4   // Per layer
+#define CLOUD_PUFFS 3
+#define CLOUD_SHADOW_VERTICES (CLOUD_COUNT * 3 * CLOUD_PUFFS * CIRCLE_VERTICES)
+#define CLOUD_BODY_VERTICES (CLOUD_COUNT * CLOUD_PUFFS * CIRCLE_VERTICES)
+float circleCos[CIRCLE_SEGMENTS];
+float circleSin[CIRCLE_SEGMENTS];
+
+// Cloud layers, back to front. Each is a band of the sky that wraps every
+// CLOUD_BAND_WIDTH pixels; the bands are cached stacked in one texture
+// (flappy_layer.h), so adding layers for parallax costs one quad each.
+#define CLOUD_LAYERS 2
+#define CLOUD_BAND_WIDTH 1024  // Power of two, for GL_REPEAT
+#define CLOUD_TEXTURE_HEIGHT 256
+#define CLOUD_PULSE 0.05f      // Brightness swing of the clouds
+float cloudBaseX[CLOUD_LAYERS][CLOUD_COUNT] = {
+    {180, 420, 650, 900},
+    {100, 300, 500, 700}
+};
+float cloudBaseY[CLOUD_LAYERS][CLOUD_COUNT] = {
+    {60, 45, 70, 50},
+    {100, 150, 80, 130}
+};
+float cloudScale[CLOUD_LAYERS] = {0.6f, 1.0f};   // Puff size
+float cloudSpeed[CLOUD_LAYERS] = {0.2f, 0.5f};   // Pixels per tick
+float cloudHaze[CLOUD_LAYERS] = {0.35f, 0.0f};   // Fade towards the sky
+int cloudBandTop[CLOUD_LAYERS] = {24, 48};      // Screen rows covered by the band
+int cloudBandHeight[CLOUD_LAYERS] = {80, 144};  // (clouds, shadows included)
+
+ColorVertex birdShadowMesh[3 * CIRCLE_VERTICES];
+ColorVertex birdBodyMesh[CIRCLE_VERTICES];
+float birdBodyT[CIRCLE_VERTICES];  // Vertical gradient position per vertex
+ColorVertex birdPulseBodyMesh[CIRCLE_VERTICES];   // With shader effects
+ColorVertex birdEyeMesh[2 * CIRCLE_VERTICES];
+ColorVertex birdPupilMesh[CIRCLE_VERTICES];
+ColorVertex cloudShadowMesh[CLOUD_LAYERS][CLOUD_SHADOW_VERTICES];
+ColorVertex cloudBodyMesh[CLOUD_LAYERS][CLOUD_BODY_VERTICES];
+Layer cloudLayers;
+
+// Ground tufts: one tile, repeated along the ground and scrolled with the
+// pipes, so the ground costs the same at any width
+#define GROUND_TILE_WIDTH 32   // Tuft spacing; power of two, for GL_REPEAT
+#define GROUND_TILE_HEIGHT 16
+Layer groundLayer;
+
+// Ghost birds: the bird drawn once at GHOST_POSES rotations from -60 to 60
+// degrees into a sprite sheet, so a ghost is one textured quad. Ghosts are
+// binned by pose and pixel row; each occupied bin is drawn once with the
+// opacity of all its ghosts stacked, so a crowd costs at most one quad per
+// row and pose.
+#define GHOST_POSES 16
+#define GHOST_POSE_STEP 8.0f        // Degrees between poses
+#define GHOST_CELL 128              // Sprite size, bird centred
+#define GHOST_SHEET_WIDTH 1024      // 8 cells per row
+#define GHOST_SHEET_HEIGHT 256      // 2 rows
+#define GHOST_ALPHA 0.25f
+#define GHOST_ROWS (WINDOW_HEIGHT + GHOST_CELL)  // Bins, from y = -GHOST_CELL / 2
+GLfloat ghostColor[] = {1.0f, 1.0f, 1.0f};  // Tint
+Layer ghostLayer;
+int ghostBounds[GHOST_POSES][4];  // Drawn pixels of each cell: x1, y1, x2, y2
+ColorVertex ghostBodyMesh[CIRCLE_VERTICES];  // Without render-to-texture
+int ghostBins[GHOST_POSES][GHOST_ROWS];  // Ghosts per pose and row; a set holds up to 1 << 24 runs
+
+bool layersBuilt = false;  // Tried once a context is current
+
+// Frame time in ms, as passed to sceneRender()
+int frameTimeMs = 0;
+
+// HUD strings, formatted again only when the numbers change
+char scoreText[50];
+char highScoreText[50];
+int hudScore = -1;
+int hudHighScore = -1;
+
+// Write an ellipse as CIRCLE_VERTICES triangle vertices; t (optional)
+// receives each vertex's vertical gradient position
+ColorVertex* appendEllipse(ColorVertex* out, float* t, float cx, float cy, float rx, float ry,
+                           float r, float g, float b, float a) {
+    for (int i = 1; i < CIRCLE_SEGMENTS - 1; i++) {
+        const int corners[3] = {0, i, i + 1};
+        for (int k = 0; k < 3; k++) {
+            int j = corners[k];
+            out->x = cx + rx * circleCos[j];
+            out->y = cy + ry * circleSin[j];
+            out->r = colorToByte(r);
+            out->g = colorToByte(g);
+            out->b = colorToByte(b);
+            out->a = colorToByte(a);
+            memset(out->effect, 0, sizeof(out->effect));
+            out++;
+            if (t) {
+                *t++ = (circleSin[j] + 1) / 2.0f;
+            }
+        }
+    }
+    return out;
+}
+
+// Build the cached geometry
+void initGeometry() {
+    for (int i = 0; i < CIRCLE_SEGMENTS; i++) {
+        float angle = i * 36 * 3.14159 / 180;
+        circleCos[i] = cos(angle);
+        circleSin[i] = sin(angle);
+    }
+    
+    // Bird shadow layers, relative to the bird centre
+    ColorVertex* v = birdShadowMesh;
+    for (int i = 0; i < 3; i++) {
+        float radius = BIRD_SIZE + (i * 2);
+        v = appendEllipse(v, NULL, 0, 0, radius * 1.2, radius, 0.0f, 0.0f, 0.0f, 0.1f - (i * 0.03f));
+    }
+    
+    // Bird body (colors are filled in per frame)
+    appendEllipse(birdBodyMesh, birdBodyT, 0, 0, BIRD_RADIUS_X, BIRD_RADIUS_Y, 0, 0, 0, 1);
+    
+    // The same with shader effects: gradient colors at rest, and the pulse
+    // weights for the GPU
+    appendEllipse(birdPulseBodyMesh, NULL, 0, 0, BIRD_RADIUS_X, BIRD_RADIUS_Y, 0, 0, 0, 1);
+    for (int i = 0; i < CIRCLE_VERTICES; i++) {
+        float t = birdBodyT[i];
+        GLubyte* rgb = &birdPulseBodyMesh[i].r;
+        birdPulseBodyMesh[i].effect[0] = EFFECT_WAVE2;
+        for (int ch = 0; ch < 3; ch++) {
+            rgb[ch] = colorToByte(birdGradient.top[ch] * t + birdGradient.bottom[ch] * (1-t));
+            birdPulseBodyMesh[i].effect[1 + ch] = colorToByte(birdGradient.top[ch] * t);
+        }
+    }
+    
+    // Waves of the sky, ground and bird colors
+    batchEffectWave(EFFECT_WAVE0, SKY_SHIFT_AMPLITUDE, SKY_SHIFT_RATE);
+    batchEffectWave(EFFECT_WAVE1, GROUND_SHIFT_AMPLITUDE, GROUND_SHIFT_RATE);
+    batchEffectWave(EFFECT_WAVE2, BIRD_PULSE_AMPLITUDE, BIRD_PULSE_RATE);
+    
+    appendEllipse(ghostBodyMesh, NULL, 0, 0, BIRD_RADIUS_X, BIRD_RADIUS_Y,
+                  ghostColor[0], ghostColor[1], ghostColor[2], GHOST_ALPHA);
+    
+    // Eye base and highlight, and the pupil before its per-frame offset
+    v = appendEllipse(birdEyeMesh, NULL, BIRD_SIZE * 0.7, -5, 5, 5, 0.0f, 0.0f, 0.0f, 1.0f);
+    appendEllipse(v, NULL, BIRD_SIZE * 0.7, -6, 2, 2, 1.0f, 1.0f, 1.0f, 1.0f);
+    appendEllipse(birdPupilMesh, NULL, BIRD_SIZE * 0.7, -5, 1.5, 1.5, 0.0f, 0.0f, 0.0f, 1.0f);
+    
+    // Cloud shadow layers and bodies in band coordinates. Bodies get the
+    // gradient at the top of the pulse; the pulse itself is a tint.
+    for (int l = 0; l < CLOUD_LAYERS; l++) {
+        v = cloudShadowMesh[l];
+        ColorVertex* body = cloudBodyMesh[l];
+        float radius = 25 * cloudScale[l];
+        for (int c = 0; c < CLOUD_COUNT; c++) {
+            for (int s = 0; s < 3; s++) {
+                float alpha = (0.15f - (s * 0.05f)) * (1 - cloudHaze[l]);
+                float offset = s * 2.0f * cloudScale[l];
+                for (int i = 0; i < CLOUD_PUFFS; i++) {
+                    v = appendEllipse(v, NULL, cloudBaseX[l][c] + i * radius + offset,
+                                      cloudBaseY[l][c] + offset, radius, radius,
+                                      0.0f, 0.0f, 0.0f, alpha);
+                }
+            }
+            for (int i = 0; i < CLOUD_PUFFS; i++) {
+                float t[CIRCLE_VERTICES];
+                ColorVertex* puff = body;
+                body = appendEllipse(body, t, cloudBaseX[l][c] + i * radius, cloudBaseY[l][c],
+                                     radius, radius, 1, 1, 1, 1);
+                for (int k = 0; k < CIRCLE_VERTICES; k++) {
+                    GLubyte* rgb = &puff[k].r;
+                    for (int ch = 0; ch < 3; ch++) {
+                        float lit = cloudColor[ch] * (t[k] + CLOUD_PULSE) + cloudShadowColor[ch] * (1-t[k]);
+                        rgb[ch] = colorToByte(lit + (skyGradient.top[ch] - lit) * cloudHaze[l]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Function to draw a gradient rectangle
+void drawGradientRect(float x1, float y1, float x2, float y2, 
+                     GLfloat topColor[3], GLfloat bottomColor[3]) {
+    batchBegin(GL_QUADS);
+    // Top vertices
+    batchColor3f(topColor[0], topColor[1], topColor[2]);
+    batchVertex2f(x1, y1);
+    batchVertex2f(x2, y1);
+    
+    // Bottom vertices
+    batchColor3f(bottomColor[0], bottomColor[1], bottomColor[2]);
+    batchVertex2f(x2, y2);
+    batchVertex2f(x1, y2);
+    batchEnd();
+}
+
+// A gradient rectangle whose colors shift with a wave effect, each end by
+// its weights; for shader effects
+void drawWaveRect(float x1, float y1, float x2, float y2,
+                  GLfloat topColor[3], GLfloat bottomColor[3],
+                  int effect, GLfloat topWeights[3], GLfloat bottomWeights[3]) {
+    batchBegin(GL_QUADS);
+    batchEffect(effect, topWeights[0], topWeights[1], topWeights[2]);
+    batchColor3f(topColor[0], topColor[1], topColor[2]);
+    batchVertex2f(x1, y1);
+    batchVertex2f(x2, y1);
+    
+    batchEffect(effect, bottomWeights[0], bottomWeights[1], bottomWeights[2]);
+    batchColor3f(bottomColor[0], bottomColor[1], bottomColor[2]);
+    batchVertex2f(x2, y2);
+    batchVertex2f(x1, y2);
+    batchEnd();
+    batchEffect(EFFECT_NONE, 0, 0, 0);
+}
+
+// Function to draw shadow
+void drawShadow(float x, float y, float size, float alpha) {
+    batchColor4f(0.0f, 0.0f, 0.0f, alpha);
+    batchBegin(GL_POLYGON);
+    for (int i = 0; i < CIRCLE_SEGMENTS; i++) {
+        batchVertex2f(x + size * circleCos[i], y + size * circleSin[i]);
+    }
+    batchEnd();
+}
+
+//for animation
+// Animation variables //animation_variables.h
+float birdWingAngle = 0.0f;
+float birdWingSpeed = 15.0f;  // Increased speed for more dynamic movement
+bool wingDirection = true;
+float birdWingScale = 1.0f;   // For wing scaling effect
+float birdWingScaleSpeed = 0.05f;
+bool wingScaleDirection = true;
+
+// Particle system
+ParticlePool particles;
+int particleCapacity = DEFAULT_PARTICLE_CAPACITY;  // --particles N
+
+// Interpolation factor between the previous and current tick for drawing
+float renderAlpha = 1.0f;
+
+
+//animation_function.h
+// Initialize particles
+void initParticles() {
+    particlesInit(particles, particleCapacity);
+}
+
+// Create particles at position
+void createParticles(float x, float y, float r, float g, float b) {
+    particlesEmit(particles, x, y, r, g, b);
+}
+
+// Update particles
+void updateParticles() {
+    PROFILE_SCOPE(PROFILE_PARTICLES);
+    particlesUpdate(particles);
+}
+
+// Draw particles
+void drawParticles() {
+    PROFILE_SCOPE(PROFILE_DRAW_PARTICLES);
+    renderParticles(particles, renderAlpha);
+}
+
+
+
+
+// Game Variables
+GameState currentState = MENU;
+int menuSelection = 0;
+
+// Bird, pipes and score live in the simulation state
+SimState sim;
+SimState prevSim;  // State before the last tick
+SimState view;     // Interpolated state that the draw functions read
+bool flapQueued = false;  // Flap requested by input, applied on the next tick
+unsigned int runSeed = 0;  // Level seed of the next run
+int levelPipes = MAX_PIPES;
+int levelSpacing = PIPE_SPACING;
+bool levelSwept = false;
+LevelFile levelFile;             // --level FILE, mapped while loaded
+const LevelFile* level = NULL;   // The loaded level, or NULL for generated pipes
+
+// Ghost racing
+GhostSet ghosts;
+bool racing = false;
+const char* racePath = NULL;  // --race FILE: loaded at start, saved after each run
+
+// Input replays
+const char* recordPath = NULL;  // --record FILE: every finished run is saved
+Replay recording;
+bool replayPlaying = false;     // --play FILE: flaps come from playback
+Replay playback;
+int playbackCursor = 0;
+
+// Colors
+GLfloat skyColor[] = {0.4f, 0.7f, 1.0f};
+GLfloat groundColor[] = {0.8f, 0.6f, 0.3f};
+GLfloat birdColor[] = {1.0f, 1.0f, 0.0f};
+GLfloat pipeColor[] = {0.0f, 0.8f, 0.0f};
+GLfloat textColor[] = {1.0f, 1.0f, 1.0f};
+GLfloat highlightColor[] = {1.0f, 0.8f, 0.0f};
+
+// Add highlight colors for the bird
+GLfloat birdHighlightColor[] = {1.0f, 1.0f, 0.8f};
+GLfloat birdShadowColor[] = {0.8f, 0.6f, 0.0f};
+
+// Add pipe highlight and shadow colors
+GLfloat pipeHighlightColor[] = {0.2f, 0.9f, 0.4f};
+GLfloat pipeShadowColor[] = {0.1f, 0.5f, 0.2f};
+
+// Add cloud animation variables
+float cloudOffset[CLOUD_LAYERS];      // Band scroll, in [0, CLOUD_BAND_WIDTH)
+float prevCloudOffset[CLOUD_LAYERS];
+
+// Add ground highlight and shadow colors
+GLfloat groundHighlightColor[] = {0.6f, 0.4f, 0.2f};
+GLfloat groundShadowColor[] = {0.3f, 0.2f, 0.1f};
+
+// Add celebration colors
+GLfloat celebrationColors[][3] = {
+    {1.0f, 0.0f, 0.0f},  // Red
+    {0.0f, 1.0f, 0.0f},  // Green
+    {0.0f, 0.0f, 1.0f},  // Blue
+    {1.0f, 1.0f, 0.0f},  // Yellow
+    {1.0f, 0.0f, 1.0f}   // Purple
+};
+
+// Add milestone messages
+const char* milestoneMessages[] = {
+    "5 POINTS!",
+    "10 POINTS!",
+    "20 POINTS!",
+    "40 POINTS!",
+    "80 POINTS!"
+};
+
+// Blend the previous and current tick for smooth drawing
+void interpolateView(float alpha) {
+    view = sim;
+    view.birdY = prevSim.birdY + (sim.birdY - prevSim.birdY) * alpha;
+    view.birdRotation = prevSim.birdRotation + (sim.birdRotation - prevSim.birdRotation) * alpha;
+    // Pipes stay put in level coordinates; only the scroll moves
+    float scrolled = sim.scroll - prevSim.scroll;
+    if (scrolled < 0) {
+        scrolled += SIM_SCROLL_REBASE;  // Rebased on this tick
+    }
+    view.scroll = sim.scroll - scrolled * (1 - alpha);
+}
+
+// Format the score strings if the score changed since the last frame
+void updateHudText() {
+    if (view.score != hudScore) {
+        sprintf(scoreText, "Score: %d", view.score);
+        hudScore = view.score;
+    }
+    if (view.highScore != hudHighScore) {
+        sprintf(highScoreText, "High Score: %d", view.highScore);
+        hudHighScore = view.highScore;
+    }
+}
+
+// Set up geometry, particles and a new world
+void sceneInit(unsigned int seed) {
+    initGeometry();
+    initParticles();
+    sceneReset(seed);
+}
+
+// Back to the main menu with a new world and the animations at rest
+void sceneReset(unsigned int seed) {
+    currentState = MENU;
+    menuSelection = 0;
+    simInit(sim, seed);
+    simSetLevel(sim, levelPipes, levelSpacing);
+    simSetSweptCollision(sim, levelSwept);
+    simSetLevelFile(sim, level);
+    simRestart(sim, seed);
+    prevSim = sim;
+    view = sim;
+    flapQueued = false;
+    runSeed = seed;
+    particlesClear(particles);
+    particlesSeed(particles, seed);
+    
+    for (int l = 0; l < CLOUD_LAYERS; l++) {
+        cloudOffset[l] = prevCloudOffset[l] = 0.0f;
+    }
+    birdWingAngle = 0.0f;
+    wingDirection = true;
+    birdWingScale = 1.0f;
+    wingScaleDirection = true;
+}
+
+// Draw the current screen into the current context
+void sceneRender(int timeMs, float alpha) {
+    glClear(GL_COLOR_BUFFER_BIT);
+    glLoadIdentity();
+    renderStats.glCalls += 2;
+    
+    // Draw the cached layers once the context is current
+    if (!layersBuilt) {
+        layerBuild(cloudLayers, CLOUD_BAND_WIDTH, CLOUD_TEXTURE_HEIGHT, drawCloudTexture);
+        layerBuild(groundLayer, GROUND_TILE_WIDTH, GROUND_TILE_HEIGHT, drawGroundTile);
+        if (layerBuild(ghostLayer, GHOST_SHEET_WIDTH, GHOST_SHEET_HEIGHT, drawGhostPoses)) {
+            measureGhostPoses();
+        }
+        layersBuilt = true;
+    }
+    
+    frameTimeMs = timeMs;
+    batchEffectTime(timeMs * 0.001f);
+    renderAlpha = alpha;
+    interpolateView(renderAlpha);
+    updateHudText();
+    
+    // Draw different screens based on game state
+    switch (currentState) {
+        case MENU:
+            drawSky();
+            drawGround();
+            drawMenu();
+            break;
+        case INSTRUCTIONS:
+            drawSky();
+            drawGround();
+            drawInstructions();
+            break;
+        case PLAYING:
+            drawSky();
+            drawPipes();
+            drawGhosts();
+            drawBird();
+            drawParticles();
+            drawGround();
+            drawScore();
+            if (view.isCelebrating) {
+                drawCelebration();
+            }
+            break;
+        case GAME_OVER:
+            drawSky();
+            drawPipes();
+            drawGhosts();
+            drawBird();
+            drawParticles();
+            drawGround();
+            drawGameOver();
+            break;
+    }
+    
+    {
+        PROFILE_SCOPE(PROFILE_FLUSH);
+        batchFlush();
+    }
+}
+
+// Wing and particle effect of a flap
+static void flapEffects() {
+    createParticles(sim.birdX, sim.birdY + BIRD_SIZE, 1.0f, 1.0f, 1.0f);
+    birdWingAngle = -45;
+    wingDirection = true;
+}
+
+void sceneFlap() {
+    flapQueued = true;
+    flapEffects();
+}
+
+void sceneRecord(const char* path) {
+    recordPath = path;
+    replayInit(recording, 0);
+}
+
+bool sceneLoadLevel(const char* path) {
+    if (level) {
+        levelClose(levelFile);
+        level = NULL;
+    }
+    if (!levelOpen(levelFile, path)) {
+        return false;
+    }
+    // Read once up front: the simulation trusts every record
+    if (!levelVerify(levelFile)) {
+        levelClose(levelFile);
+        return false;
+    }
+    level = &levelFile;
+    return true;
+}
+
+bool scenePlay(const char* path) {
+    if (!replayLoad(playback, path)) {
+        return false;
+    }
+    if (playback.levelChecksum != 0 &&
+        (!level || level->header->dataChecksum != playback.levelChecksum)) {
+        printf("replay: %s was played on another level file\n", path);
+        return false;
+    }
+    replayPlaying = true;
+    return true;
+}
+
+bool sceneRace(const char* path) {
+    if (racing) {
+        sceneStopRace();
+    }
+    unsigned int levelChecksum = level ? level->header->dataChecksum : 0;
+    if (path && ghostLoad(ghosts, path)) {
+        if (ghosts.levelChecksum != levelChecksum) {
+            printf("race: %s was recorded on another level file\n", path);
+            ghostFree(ghosts);
+            return false;
+        }
+        printf("race: %d ghosts from %s\n", ghosts.runCount, path);
+    } else {
+        FILE* f = path ? fopen(path, "rb") : NULL;
+        if (f) {
+            fclose(f);  // There, but not a ghost file
+            return false;
+        }
+        ghostInit(ghosts, runSeed);
+        ghosts.pipeCount = levelPipes;
+        ghosts.pipeSpacing = levelSpacing;
+        ghosts.sweptCollision = levelSwept;
+        ghosts.levelChecksum = levelChecksum;
+    }
+    racePath = path;
+    racing = true;
+    return true;
+}
+
+void sceneStopRace() {
+    ghostFree(ghosts);
+    racePath = NULL;
+    racing = false;
+}
+
+// Keep the finished run as a ghost
+static void finishRace() {
+    ghostEndRun(ghosts);
+    if (racePath) {
+        if (ghostSave(ghosts, racePath)) {
+            printf("race: score %d, %d ghosts saved to %s\n", sim.score, ghosts.runCount, racePath);
+        } else {
+            printf("race: cannot write %s\n", racePath);
+        }
+    }
+}
+
+// Save the finished run, or check it against the one played back
+static void finishReplay() {
+    if (recordPath) {
+        replayFinish(recording, sim);
+        if (replaySave(recording, recordPath)) {
+            printf("replay: seed %u, score %d, died at tick %u, saved to %s\n",
+                   recording.seed, recording.score, recording.deathTick, recordPath);
+        } else {
+            printf("replay: cannot write %s\n", recordPath);
+        }
+    }
+    if (replayPlaying) {
+        bool ok = sim.tick == playback.deathTick && sim.score == playback.score;
+        printf("replay: %s (score %d, died at tick %u; recorded %d at tick %u)\n",
+               ok ? "ok" : "MISMATCH", sim.score, sim.tick, playback.score, playback.deathTick);
+    }
+}
+
+bool sceneBusy() {
+    // Celebrations only play (and only advance) while playing
+    return currentState == PLAYING || particles.count > 0;
+}
+
+// Advance the game by one fixed tick
+void tick() {
+    prevSim = sim;
+    for (int l = 0; l < CLOUD_LAYERS; l++) {
+        prevCloudOffset[l] = cloudOffset[l];
+    }
+    
+    if (currentState == PLAYING) {
+        // Advance the simulation by one tick
+        SimInput input = { flapQueued };
+        flapQueued = false;
+        if (replayPlaying) {
+            input.flap = replayFlapAt(playback, playbackCursor, sim.tick);
+            if (input.flap) {
+                flapEffects();
+            }
+        }
+        if (recordPath && input.flap) {
+            replayAddFlap(recording, sim.tick);
+        }
+        SimEvents events = simStep(sim, input);
+        if (racing) {
+            ghostAddTick(ghosts, sim.birdY);
+        }
+
+        if (events.milestone) {
+            // Create celebration particles
+            particlesBurst(particles, 50, sim.birdX, sim.birdY, celebrationColors, 5);
+        }
+
+        // Update wing animation
+        birdWingAngle += birdWingSpeed * (wingDirection ? 1 : -1);
+        if (birdWingAngle > 45) wingDirection = false;
+        if (birdWingAngle < -45) wingDirection = true;
+        
+        // Create trail particles
+        if (randomRange(particles.rng, 3) == 0) {
+            createParticles(sim.birdX - BIRD_SIZE, sim.birdY, 1.0f, 1.0f, 0.8f);
+        }
+        
+        if (events.died) {
+            createParticles(sim.birdX, sim.birdY, 1.0f, 0.0f, 0.0f);
+            currentState = GAME_OVER;
+            finishReplay();
+            if (racing) {
+                finishRace();
+            }
+        }
+    }
+    
+    // Update cloud positions
+    for (int l = 0; l < CLOUD_LAYERS; l++) {
+        cloudOffset[l] += cloudSpeed[l];
+        if (cloudOffset[l] >= CLOUD_BAND_WIDTH) cloudOffset[l] -= CLOUD_BAND_WIDTH;
+    }
+    
+    // Update wing scale
+    if (wingScaleDirection) {
+        birdWingScale += birdWingScaleSpeed;
+        if (birdWingScale > 1.2f) wingScaleDirection = false;
+    } else {
+        birdWingScale -= birdWingScaleSpeed;
+        if (birdWingScale < 0.8f) wingScaleDirection = true;
+    }
+    
+    // Update particles
+    updateParticles();
+}
+
+// Draw bird
+void drawBird() {
+    PROFILE_SCOPE(PROFILE_BIRD);
+    drawBirdAt(view.birdX, view.birdY, view.birdRotation);
+}
+
+// The bird's shapes, centred at x, y and turned by rotation degrees
+void drawBirdAt(float x, float y, float rotation) {
+    batchPushMatrix();
+    batchTranslatef(x, y);
+    batchRotatef(rotation);
+    
+    if (batchEffectsActive()) {
+        // Soft shadow and pulse on the GPU
+        batchColor4f(0.0f, 0.0f, 0.0f, BIRD_SHADOW_ALPHA);
+        batchSoftEllipse(0, 0, (BIRD_SIZE + 4) * 1.2f, BIRD_SIZE + 4, BIRD_SHADOW_EDGE);
+        batchTriangles(birdPulseBodyMesh, CIRCLE_VERTICES);
+    } else {
+        // Enhanced shadow with blur effect
+        batchTriangles(birdShadowMesh, 3 * CIRCLE_VERTICES);
+        
+        // Enhanced bird body with dynamic gradient
+        float pulse = BIRD_PULSE_AMPLITUDE * sin(frameTimeMs * 0.001f * BIRD_PULSE_RATE);
+        for (int i = 0; i < CIRCLE_VERTICES; i++) {
+            float t = birdBodyT[i];
+            birdBodyMesh[i].r = colorToByte(birdGradient.top[0] * (t + pulse) + birdGradient.bottom[0] * (1-t));
+            birdBodyMesh[i].g = colorToByte(birdGradient.top[1] * (t + pulse) + birdGradient.bottom[1] * (1-t));
+            birdBodyMesh[i].b = colorToByte(birdGradient.top[2] * (t + pulse) + birdGradient.bottom[2] * (1-t));
+        }
+        batchTriangles(birdBodyMesh, CIRCLE_VERTICES);
+    }
+    
+    // Enhanced animated wings with dynamic scaling
+    batchPushMatrix();
+    batchTranslatef(-BIRD_SIZE * 0.2, 0);
+    float wingAngle = sin(birdWingAngle) * 45.0f;  // Increased angle range
+    batchRotatef(wingAngle);
+    
+    batchScalef(birdWingScale, 1.0f);
+    
+    // Draw wings with enhanced gradient and highlight
+    batchBegin(GL_TRIANGLES);
+    // Left wing
+    batchColor3f(birdGradient.top[0], birdGradient.top[1], birdGradient.top[2]);
+    batchVertex2f(0, 0);
+    batchColor3f(birdGradient.bottom[0], birdGradient.bottom[1], birdGradient.bottom[2]);
+    batchVertex2f(-BIRD_SIZE * 1.5, -BIRD_SIZE);
+    batchVertex2f(-BIRD_SIZE * 1.5, BIRD_SIZE);
+    
+    // Right wing
+    batchColor3f(birdGradient.top[0], birdGradient.top[1], birdGradient.top[2]);
+    batchVertex2f(0, 0);
+    batchColor3f(birdGradient.bottom[0], birdGradient.bottom[1], birdGradient.bottom[2]);
+    batchVertex2f(-BIRD_SIZE * 1.5, -BIRD_SIZE);
+    batchVertex2f(-BIRD_SIZE * 1.5, BIRD_SIZE);
+    batchEnd();
+    
+    // Add wing highlights
+    batchColor3f(birdHighlightColor[0], birdHighlightColor[1], birdHighlightColor[2]);
+    batchBegin(GL_LINE_STRIP);
+    batchVertex2f(0, 0);
+    batchVertex2f(-BIRD_SIZE * 1.2, -BIRD_SIZE * 0.5);
+    batchVertex2f(-BIRD_SIZE * 1.5, 0);
+    batchVertex2f(-BIRD_SIZE * 1.2, BIRD_SIZE * 0.5);
+    batchVertex2f(0, 0);
+    batchEnd();
+    
+    batchPopMatrix();
+    
+    // Enhanced bird eye with dynamic highlight
+    batchPushMatrix();
+    
+    // Eye base and highlight
+    batchTriangles(birdEyeMesh, 2 * CIRCLE_VERTICES);
+    
+    // Pupil with dynamic movement
+    float pupilOffset = 0.5f * sin(frameTimeMs * 0.005f);
+    batchTranslatef(pupilOffset, pupilOffset);
+    batchTriangles(birdPupilMesh, CIRCLE_VERTICES);
+    batchPopMatrix();
+    
+    // Enhanced beak with gradient and highlight
+    batchBegin(GL_TRIANGLES);
+    // Beak gradient
+    batchColor3f(1.0f, 0.7f, 0.0f);
+    batchVertex2f(BIRD_SIZE * 1.2, 0);
+    batchColor3f(0.8f, 0.4f, 0.0f);
+    batchVertex2f(BIRD_SIZE * 0.8, -10);
+    batchVertex2f(BIRD_SIZE * 0.8, 10);
+    batchEnd();
+    
+    // Beak highlight
+    batchColor3f(1.0f, 0.9f, 0.3f);
+    batchBegin(GL_LINE_STRIP);
+    batchVertex2f(BIRD_SIZE * 0.8, -8);
+    batchVertex2f(BIRD_SIZE * 1.1, 0);
+    batchVertex2f(BIRD_SIZE * 0.8, 8);
+    batchEnd();
+    
+    batchPopMatrix();
+}
+
+// Draw pipes
+void drawPipes() {
+    PROFILE_SCOPE(PROFILE_PIPES);
+    // Pipes are sorted left to right, so only the visible run is walked
+    for (int k = 0; k < view.pipeCount; k++) {
+        const Pipe& pipe = simPipe(view, k);
+        float x = simPipeX(view, pipe);
+        if (x >= WINDOW_WIDTH) {
+            break;
+        }
+        if (x + PIPE_WIDTH > 0) {
+            float gapTop = pipe.gapY - pipe.gap/2;
+            float gapBottom = pipe.gapY + pipe.gap/2;
+            if (batchEffectsActive()) {
+                // One soft shadow per half, starting off screen
+                batchColor4f(0.0f, 0.0f, 0.0f, PIPE_SHADOW_ALPHA);
+                batchSoftRect(x, -PIPE_SHADOW_EDGE,
+                              x + PIPE_WIDTH + PIPE_SHADOW_SPREAD, gapTop + PIPE_SHADOW_SPREAD,
+                              PIPE_SHADOW_EDGE);
+                batchSoftRect(x, gapBottom,
+                              x + PIPE_WIDTH + PIPE_SHADOW_SPREAD, WINDOW_HEIGHT + PIPE_SHADOW_EDGE,
+                              PIPE_SHADOW_EDGE);
+            } else {
+                // Enhanced pipe shadows with depth
+                // Draw multiple shadow layers for depth effect
+                for (int s = 0; s < 3; s++) {
+                    float alpha = 0.15f - (s * 0.05f);
+                    float offset = s * 2.0f;
+                
+                    // Top pipe shadow
+                    batchColor4f(0.0f, 0.0f, 0.0f, alpha);
+                    batchBegin(GL_QUADS);
+                    batchVertex2f(x + offset, 0);
+                    batchVertex2f(x + PIPE_WIDTH + offset, 0);
+                    batchVertex2f(x + PIPE_WIDTH + offset, 
+                                gapTop + offset);
+                    batchVertex2f(x + offset, 
+                                gapTop + offset);
+                    batchEnd();
+                
+                    // Bottom pipe shadow
+                    batchBegin(GL_QUADS);
+                    batchVertex2f(x + offset, 
+                                gapBottom + offset);
+                    batchVertex2f(x + PIPE_WIDTH + offset, 
+                                gapBottom + offset);
+                    batchVertex2f(x + PIPE_WIDTH + offset, WINDOW_HEIGHT);
+                    batchVertex2f(x + offset, WINDOW_HEIGHT);
+                    batchEnd();
+                }
+            }
+            
+            // Draw pipes with enhanced 3D effect
+            // Top pipe
+            drawGradientRect(x, 0, 
+                           x + PIPE_WIDTH, gapTop,
+                           pipeGradient.top, pipeGradient.bottom);
+            
+            // Bottom pipe
+            drawGradientRect(x, gapBottom,
+                           x + PIPE_WIDTH, WINDOW_HEIGHT,
+                           pipeGradient.top, pipeGradient.bottom);
+            
+            // Enhanced pipe caps with 3D effect
+            GLfloat capTop[] = {0.180f, 0.549f, 0.372f};
+            GLfloat capBottom[] = {0.180f, 0.449f, 0.372f};
+            
+            // Top pipe cap with highlight
+            drawGradientRect(x - PIPE_CAP_OVERHANG, gapTop - PIPE_CAP_HEIGHT,
+                           x + PIPE_WIDTH + PIPE_CAP_OVERHANG, gapTop,
+                           capTop, capBottom);
+            
+            // Add highlight to top cap
+            batchColor3f(pipeHighlightColor[0], pipeHighlightColor[1], pipeHighlightColor[2]);
+            batchBegin(GL_LINE_STRIP);
+            batchVertex2f(x - PIPE_CAP_OVERHANG, gapTop - PIPE_CAP_HEIGHT);
+            batchVertex2f(x + PIPE_WIDTH + PIPE_CAP_OVERHANG, gapTop - PIPE_CAP_HEIGHT);
+            batchEnd();
+            
+            // Bottom pipe cap with shadow
+            drawGradientRect(x - PIPE_CAP_OVERHANG, gapBottom,
+                           x + PIPE_WIDTH + PIPE_CAP_OVERHANG, gapBottom + PIPE_CAP_HEIGHT,
+                           capTop, capBottom);
+            
+            // Add shadow to bottom cap
+            batchColor3f(pipeShadowColor[0], pipeShadowColor[1], pipeShadowColor[2]);
+            batchBegin(GL_LINE_STRIP);
+            batchVertex2f(x - PIPE_CAP_OVERHANG, gapBottom + PIPE_CAP_HEIGHT);
+            batchVertex2f(x + PIPE_WIDTH + PIPE_CAP_OVERHANG, gapBottom + PIPE_CAP_HEIGHT);
+            batchEnd();
+            
+            // Add pipe texture details
+            batchColor3f(0.1f, 0.1f, 0.1f);
+            for (int j = 0; j < 3; j++) {
+                float y = j * 20.0f;
+                batchBegin(GL_LINES);
+                batchVertex2f(x + 10, y);
+                batchVertex2f(x + PIPE_WIDTH - 10, y);
+                batchEnd();
+            }
+        }
+    }
+}
+
+// Record one grass tuft with its shadow and texture lines, the ground's
+// top edge at y = 0
+void drawGroundTile() {
+    // Draw grass shadow
+    batchColor4f(0.0f, 0.0f, 0.0f, 0.2f);
+    batchBegin(GL_TRIANGLES);
+    batchVertex2f(2, 0);
+    batchVertex2f(17, 0);
+    batchVertex2f(9.5, 15);
+    batchEnd();
+    
+    // Draw grass with gradient
+    batchBegin(GL_TRIANGLES);
+    batchColor3f(groundHighlightColor[0], groundHighlightColor[1], groundHighlightColor[2]);
+    batchVertex2f(0, 0);
+    batchColor3f(groundShadowColor[0], groundShadowColor[1], groundShadowColor[2]);
+    batchVertex2f(15, 0);
+    batchColor3f(groundHighlightColor[0], groundHighlightColor[1], groundHighlightColor[2]);
+    batchVertex2f(7.5, 15);
+    batchEnd();
+    
+    // Draw texture pattern with depth
+    for (int j = 0; j < 3; j++) {
+        float alpha = 0.1f - (j * 0.03f);
+        batchColor4f(0.0f, 0.0f, 0.0f, alpha);
+        batchBegin(GL_LINES);
+        batchVertex2f(0, 5 + j);
+        batchVertex2f(15, 5 + j);
+        batchEnd();
+    }
+}
+
+// Draw ground
+void drawGround() {
+    PROFILE_SCOPE(PROFILE_GROUND);
+    if (batchEffectsActive()) {
+        drawWaveRect(0, WINDOW_HEIGHT - 50, WINDOW_WIDTH, WINDOW_HEIGHT,
+                     groundGradient.top, groundGradient.bottom,
+                     EFFECT_WAVE1, groundShiftTop, groundShiftBottom);
+    } else {
+        // Enhanced ground gradient with dynamic color shift
+        float time = frameTimeMs * 0.001f;
+        float colorShift = GROUND_SHIFT_AMPLITUDE * sin(time * GROUND_SHIFT_RATE);
+        
+        GLfloat dynamicTop[3], dynamicBottom[3];
+        for (int ch = 0; ch < 3; ch++) {
+            dynamicTop[ch] = groundGradient.top[ch] + colorShift * groundShiftTop[ch];
+            dynamicBottom[ch] = groundGradient.bottom[ch] + colorShift * groundShiftBottom[ch];
+        }
+        
+        // Draw ground gradient
+        drawGradientRect(0, WINDOW_HEIGHT - 50, WINDOW_WIDTH, WINDOW_HEIGHT,
+                        dynamicTop, dynamicBottom);
+    }
+    
+    // Grass tufts, moving with the pipes
+    float groundX = -view.scroll;
+    if (groundLayer.texture != 0) {
+        batchColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+        batchLayer(groundLayer, 0, GROUND_TILE_HEIGHT, groundX, WINDOW_HEIGHT - 50, WINDOW_WIDTH);
+    } else {
+        // No render-to-texture: draw every tuft on screen
+        float firstX = floor(groundX + 0.5f);
+        firstX -= GROUND_TILE_WIDTH * ceil(firstX / GROUND_TILE_WIDTH);
+        batchPushMatrix();
+        batchTranslatef(firstX, WINDOW_HEIGHT - 50);
+        for (float x = firstX; x < WINDOW_WIDTH; x += GROUND_TILE_WIDTH) {
+            drawGroundTile();
+            batchTranslatef(GROUND_TILE_WIDTH, 0);
+        }
+        batchPopMatrix();
+    }
+}
+
+// Record one cloud layer at its screen position. Clouds never overlap, so
+// all shadows can go before all bodies.
+void drawCloudLayer(int layer) {
+    batchTriangles(cloudShadowMesh[layer], CLOUD_SHADOW_VERTICES);
+    batchTriangles(cloudBodyMesh[layer], CLOUD_BODY_VERTICES);
+}
+
+// Every cloud band, stacked from the top of the cloud texture
+void drawCloudTexture() {
+    int row = 0;
+    for (int l = 0; l < CLOUD_LAYERS; l++) {
+        batchPushMatrix();
+        batchTranslatef(0, row - cloudBandTop[l]);
+        drawCloudLayer(l);
+        batchPopMatrix();
+        row += cloudBandHeight[l];
+    }
+}
+
+// Draw sky
+void drawSky() {
+    PROFILE_SCOPE(PROFILE_SKY);
+    float time = frameTimeMs * 0.001f;
+    if (batchEffectsActive()) {
+        drawWaveRect(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT - 50,
+                     skyGradient.top, skyGradient.bottom,
+                     EFFECT_WAVE0, skyShiftTop, skyShiftBottom);
+    } else {
+        // Enhanced sky gradient with dynamic color shift
+        float colorShift = SKY_SHIFT_AMPLITUDE * sin(time * SKY_SHIFT_RATE);
+        
+        GLfloat dynamicTop[3], dynamicBottom[3];
+        for (int ch = 0; ch < 3; ch++) {
+            dynamicTop[ch] = skyGradient.top[ch] + colorShift * skyShiftTop[ch];
+            dynamicBottom[ch] = skyGradient.bottom[ch] + colorShift * skyShiftBottom[ch];
+        }
+        
+        drawGradientRect(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT - 50,
+                        dynamicTop, dynamicBottom);
+    }
+    
+    // Clouds: one cached band per layer, tinted by the pulse
+    int row = 0;
+    for (int l = 0; l < CLOUD_LAYERS; l++) {
+        // Interpolate the scroll, across the wrap-around too
+        float moved = cloudOffset[l] - prevCloudOffset[l];
+        if (moved < 0) {
+            moved += CLOUD_BAND_WIDTH;
+        }
+        float cloudX = cloudOffset[l] - moved * (1 - renderAlpha);
+        
+        if (cloudLayers.texture != 0) {
+            float tint = 1 - CLOUD_PULSE + CLOUD_PULSE * sin(time + l * 0.5f);
+            batchColor4f(tint, tint, tint, 1.0f);
+            batchLayer(cloudLayers, row, cloudBandHeight[l], cloudX, cloudBandTop[l], WINDOW_WIDTH);
+        } else {
+            // No render-to-texture: draw the clouds themselves, and their
+            // wrapped copy to the left
+            batchPushMatrix();
+            batchTranslatef(floor(cloudX + 0.5f), 0);
+            drawCloudLayer(l);
+            batchTranslatef(-CLOUD_BAND_WIDTH, 0);
+            drawCloudLayer(l);
+            batchPopMatrix();
+        }
+        row += cloudBandHeight[l];
+    }
+}
+
+// Free the cached cloud bands and ground tile; they are built again on
+// the next frame
+void sceneFreeLayers() {
+    layerFree(cloudLayers);
+    layerFree(groundLayer);
+    layerFree(ghostLayer);
+    layersBuilt = false;
+}
+
+// Every ghost pose in its cell of the sheet, with the animations at rest
+void drawGhostPoses() {
+    float wingAngle = birdWingAngle, wingScale = birdWingScale;
+    int timeMs = frameTimeMs;
+    birdWingAngle = 0.0f;
+    birdWingScale = 1.0f;
+    frameTimeMs = 0;
+    batchEffectTime(0);
+    int columns = GHOST_SHEET_WIDTH / GHOST_CELL;
+    for (int p = 0; p < GHOST_POSES; p++) {
+        drawBirdAt((p % columns + 0.5f) * GHOST_CELL, (p / columns + 0.5f) * GHOST_CELL,
+                   -60.0f + p * GHOST_POSE_STEP);
+    }
+    birdWingAngle = wingAngle;
+    birdWingScale = wingScale;
+    frameTimeMs = timeMs;
+    batchEffectTime(timeMs * 0.001f);
+}
+
+// Find the drawn part of each pose, so ghost quads skip the empty corners
+// of their cells (ghosts are fill-bound in software GL)
+void measureGhostPoses() {
+    GLubyte* pixels = (GLubyte*)malloc(GHOST_SHEET_WIDTH * GHOST_SHEET_HEIGHT * 4);
+    if (!pixels) return;
+    glBindTexture(GL_TEXTURE_2D, ghostLayer.texture);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    int columns = GHOST_SHEET_WIDTH / GHOST_CELL;
+    for (int p = 0; p < GHOST_POSES; p++) {
+        int* b = ghostBounds[p];
+        b[0] = b[1] = GHOST_CELL;
+        b[2] = b[3] = 0;
+        for (int y = 0; y < GHOST_CELL; y++) {
+            // Texture rows go bottom-up: sheet row r is texture row height - 1 - r
+            int row = GHOST_SHEET_HEIGHT - 1 - ((p / columns) * GHOST_CELL + y);
+            const GLubyte* line = pixels + (row * GHOST_SHEET_WIDTH + (p % columns) * GHOST_CELL) * 4;
+            for (int x = 0; x < GHOST_CELL; x++) {
+                if (line[x * 4 + 3]) {
+                    if (x < b[0]) b[0] = x;
+                    if (y < b[1]) b[1] = y;
+                    if (x + 1 > b[2]) b[2] = x + 1;
+                    if (y + 1 > b[3]) b[3] = y + 1;
+                }
+            }
+        }
+    }
+    free(pixels);
+}
+
+// Draw the ghosts of the finished runs at the live bird's tick
+void drawGhosts() {
+    if (!racing) return;
+    PROFILE_SCOPE(PROFILE_GHOSTS);
+    int runs = ghostFinishedRuns(ghosts);
+    int t = (int)view.tick;
+    memset(ghostBins, 0, sizeof(ghostBins));
+    int occupied = 0;
+    for (int r = 0; r < runs; r++) {
+        if (t >= ghosts.runLength[r]) {
+            continue;  // Already crashed
+        }
+        // Heights are kept per tick; the rotation follows from the move
+        float y = ghostHeight(ghosts, r, t);
+        float velocity = t > 0 ? y - ghostHeight(ghosts, r, t - 1) : 0;
+        y -= velocity * (1 - renderAlpha);
+        float rotation = velocity * 3;
+        int pose = (int)floor((rotation + 60.0f) / GHOST_POSE_STEP + 0.5f);
+        pose = pose < 0 ? 0 : pose >= GHOST_POSES ? GHOST_POSES - 1 : pose;
+        int row = (int)floor(y + 0.5f) + GHOST_CELL / 2;
+        if (row < 0 || row >= GHOST_ROWS) {
+            continue;
+        }
+        occupied += ghostBins[pose][row]++ == 0;
+    }
+    if (occupied == 0) return;
+
+    int columns = GHOST_SHEET_WIDTH / GHOST_CELL;
+    float x = view.birdX;
+    for (int p = 0; p < GHOST_POSES; p++) {
+        for (int row = 0; row < GHOST_ROWS; row++) {
+            int count = ghostBins[p][row];
+            if (count == 0) continue;
+            // count ghosts of opacity a stacked: 1 - (1 - a)^count
+            float alpha = 1.0f - pow(1.0f - GHOST_ALPHA, count);
+            float y = row - GHOST_CELL / 2;
+            if (ghostLayer.texture) {
+                // Rows were drawn top-down, so row r is at v = 1 - r / height
+                const int* b = ghostBounds[p];
+                float left = (p % columns) * GHOST_CELL;
+                float top = (p / columns) * GHOST_CELL;
+                float cornerX = x - GHOST_CELL / 2, cornerY = y - GHOST_CELL / 2;
+                batchColor4f(ghostColor[0], ghostColor[1], ghostColor[2], alpha);
+                batchTexturedQuad(ghostLayer.texture, cornerX + b[0], cornerY + b[1],
+                                  cornerX + b[2], cornerY + b[3],
+                                  (left + b[0]) / GHOST_SHEET_WIDTH,
+                                  1 - (top + b[1]) / GHOST_SHEET_HEIGHT,
+                                  (left + b[2]) / GHOST_SHEET_WIDTH,
+                                  1 - (top + b[3]) / GHOST_SHEET_HEIGHT);
+            } else {
+                // No render-to-texture: the body alone
+                for (int i = 0; i < CIRCLE_VERTICES; i++) {
+                    ghostBodyMesh[i].a = colorToByte(alpha);
+                }
+                batchPushMatrix();
+                batchTranslatef(x, y);
+                batchRotatef(-60.0f + p * GHOST_POSE_STEP);
+                batchTriangles(ghostBodyMesh, CIRCLE_VERTICES);
+                batchPopMatrix();
+            }
+        }
+    }
+}
+
+// Draw menu
+void drawMenu() {
+    batchColor3f(0.0, 0.0, 0.0);
+    batchBegin(GL_QUADS);
+    batchVertex2f(WINDOW_WIDTH/2 - 150, WINDOW_HEIGHT/2 - 100);
+    batchVertex2f(WINDOW_WIDTH/2 + 150, WINDOW_HEIGHT/2 - 100);
+    batchVertex2f(WINDOW_WIDTH/2 + 150, WINDOW_HEIGHT/2 + 100);
+    batchVertex2f(WINDOW_WIDTH/2 - 150, WINDOW_HEIGHT/2 + 100);
+    batchEnd();
+    
+    batchColor3f(1.0, 1.0, 1.0);
+    batchBegin(GL_LINE_LOOP);
+    batchVertex2f(WINDOW_WIDTH/2 - 150, WINDOW_HEIGHT/2 - 100);
+    batchVertex2f(WINDOW_WIDTH/2 + 150, WINDOW_HEIGHT/2 - 100);
+    batchVertex2f(WINDOW_WIDTH/2 + 150, WINDOW_HEIGHT/2 + 100);
+    batchVertex2f(WINDOW_WIDTH/2 - 150, WINDOW_HEIGHT/2 + 100);
+    batchEnd();
+    
+    // Enhanced menu title
+    char title[] = "FLAPPY BIRD";
+    renderText(WINDOW_WIDTH/2 - 70, WINDOW_HEIGHT/2 - 70, title, textColor, true, 1.2f);
+    
+    // Enhanced menu options
+    char newGame[] = "New Game";
+    char exit[] = "Exit";
+    
+    if (menuSelection == 0) {
+        renderText(WINDOW_WIDTH/2 - 50, WINDOW_HEIGHT/2, newGame, highlightColor, true, 1.1f);
+        renderText(WINDOW_WIDTH/2 - 25, WINDOW_HEIGHT/2 + 40, exit, textColor, false, 1.0f);
+    } else {
+        renderText(WINDOW_WIDTH/2 - 50, WINDOW_HEIGHT/2, newGame, textColor, false, 1.0f);
+        renderText(WINDOW_WIDTH/2 - 25, WINDOW_HEIGHT/2 + 40, exit, highlightColor, true, 1.1f);
+    }
+}
+
+// Draw instructions
+void drawInstructions() {
+    batchColor3f(0.0, 0.0, 0.0);
+    batchBegin(GL_QUADS);
+    batchVertex2f(WINDOW_WIDTH/2 - 200, WINDOW_HEIGHT/2 - 150);
+    batchVertex2f(WINDOW_WIDTH/2 + 200, WINDOW_HEIGHT/2 - 150);
+    batchVertex2f(WINDOW_WIDTH/2 + 200, WINDOW_HEIGHT/2 + 150);
+    batchVertex2f(WINDOW_WIDTH/2 - 200, WINDOW_HEIGHT/2 + 150);
+    batchEnd();
+    
+    batchColor3f(1.0, 1.0, 1.0);
+    batchBegin(GL_LINE_LOOP);
+    batchVertex2f(WINDOW_WIDTH/2 - 200, WINDOW_HEIGHT/2 - 150);
+    batchVertex2f(WINDOW_WIDTH/2 + 200, WINDOW_HEIGHT/2 - 150);
+    batchVertex2f(WINDOW_WIDTH/2 + 200, WINDOW_HEIGHT/2 + 150);
+    batchVertex2f(WINDOW_WIDTH/2 - 200, WINDOW_HEIGHT/2 + 150);
+    batchEnd();
+    
+    // Enhanced instructions title
+    char title[] = "INSTRUCTIONS";
+    renderText(WINDOW_WIDTH/2 - 75, WINDOW_HEIGHT/2 - 120, title, textColor, true, 1.2f);
+    
+    // Enhanced instructions text
+    char line1[] = "Press UP ARROW or SPACE to flap";
+    char line2[] = "Avoid hitting pipes";
+    char line3[] = "Score points by passing pipes";
+    char line4[] = "Press ENTER to start";
+    
+    renderText(WINDOW_WIDTH/2 - 150, WINDOW_HEIGHT/2 - 60, line1, textColor, false, 1.0f);
+    renderText(WINDOW_WIDTH/2 - 150, WINDOW_HEIGHT/2 - 20, line2, textColor, false, 1.0f);
+    renderText(WINDOW_WIDTH/2 - 150, WINDOW_HEIGHT/2 + 20, line3, textColor, false, 1.0f);
+    renderText(WINDOW_WIDTH/2 - 150, WINDOW_HEIGHT/2 + 80, line4, highlightColor, true, 1.1f);
+}
+
+// Draw game over
+void drawGameOver() {
+    batchColor3f(0.0, 0.0, 0.0);
+    batchBegin(GL_QUADS);
+    batchVertex2f(WINDOW_WIDTH/2 - 150, WINDOW_HEIGHT/2 - 100);
+    batchVertex2f(WINDOW_WIDTH/2 + 150, WINDOW_HEIGHT/2 - 100);
+    batchVertex2f(WINDOW_WIDTH/2 + 150, WINDOW_HEIGHT/2 + 100);
+    batchVertex2f(WINDOW_WIDTH/2 - 150, WINDOW_HEIGHT/2 + 100);
+    batchEnd();
+    
+    batchColor3f(1.0, 1.0, 1.0);
+    batchBegin(GL_LINE_LOOP);
+    batchVertex2f(WINDOW_WIDTH/2 - 150, WINDOW_HEIGHT/2 - 100);
+    batchVertex2f(WINDOW_WIDTH/2 + 150, WINDOW_HEIGHT/2 - 100);
+    batchVertex2f(WINDOW_WIDTH/2 + 150, WINDOW_HEIGHT/2 + 100);
+    batchVertex2f(WINDOW_WIDTH/2 - 150, WINDOW_HEIGHT/2 + 100);
+    batchEnd();
+    
+    // Enhanced game over title
+    char title[] = "GAME OVER";
+    renderText(WINDOW_WIDTH/2 - 60, WINDOW_HEIGHT/2 - 70, title, textColor, true, 1.3f);
+    
+    // Enhanced score display
+    renderText(WINDOW_WIDTH/2 - 50, WINDOW_HEIGHT/2 - 30, scoreText, textColor, true, 1.1f);
+    
+    // Enhanced high score display
+    renderText(WINDOW_WIDTH/2 - 70, WINDOW_HEIGHT/2, highScoreText, textColor, true, 1.1f);
+    
+    // Enhanced options
+    char restart[] = "Press R to Restart";
+    char quit[] = "Press Q to Quit";
+    
+    renderText(WINDOW_WIDTH/2 - 90, WINDOW_HEIGHT/2 + 40, restart, textColor, false, 1.0f);
+    renderText(WINDOW_WIDTH/2 - 70, WINDOW_HEIGHT/2 + 70, quit, textColor, false, 1.0f);
+}
+
+// Draw score
+void drawScore() {
+    // Enhanced score display
+    renderText(10, 30, scoreText, textColor, true, 1.1f);
+    
+    // Enhanced high score display
+    renderText(10, 60, highScoreText, textColor, true, 1.1f);
+}
+
+// Reset game
+void resetGame() {
+    // Every run starts from its own seed, so it can be replayed alone
+    unsigned int seed = replayPlaying ? playback.seed : racing ? ghosts.seed : runSeed++;
+    if (replayPlaying) {
+        simSetLevel(sim, playback.pipeCount, playback.pipeSpacing);
+        simSetSweptCollision(sim, playback.sweptCollision);
+        simSetLevelFile(sim, playback.levelChecksum != 0 ? level : NULL);
+    } else if (racing) {
+        simSetLevel(sim, ghosts.pipeCount, ghosts.pipeSpacing);
+        simSetSweptCollision(sim, ghosts.sweptCollision);
+        simSetLevelFile(sim, ghosts.levelChecksum != 0 ? level : NULL);
+    }
+    simRestart(sim, seed);
+    if (racing) {
+        ghostBeginRun(ghosts);
+        ghostAddTick(ghosts, sim.birdY);
+    }
+    prevSim = sim;
+    flapQueued = false;
+    playbackCursor = 0;
+    recording.seed = seed;
+    recording.pipeCount = sim.basePipeCount;
+    recording.pipeSpacing = (int)sim.pipeSpacing;
+    recording.sweptCollision = sim.sweptCollision;
+    recording.levelChecksum = sim.levelLength > 0 ? level->header->dataChecksum : 0;
+    recording.flapCount = 0;
+}
+
+// Function definition without default arguments
+// Glyphs are not scaled, as with bitmap text; scale only spreads the shadow
+void renderText(float x, float y, const char* text, GLfloat* color, bool isBold, float scale) {
+    PROFILE_SCOPE(PROFILE_TEXT);
+    // Draw text shadow for depth (opaque, as bitmap text drew it with
+    // blending off)
+    if (isBold) {
+        batchColor4f(0.0f, 0.0f, 0.0f, 1.0f);
+        batchText(x + 2.0f * scale, y - 2.0f * scale, text);
+    }
+    
+    // Draw main text
+    batchColor3f(color[0], color[1], color[2]);
+    batchText(x, y, text);
+}
+
+// Draw celebration
+void drawCelebration() {
+    if (!view.isCelebrating) return;
+
+    // Calculate milestone index
+    int milestoneIndex = 0;
+    if (view.score >= 80) milestoneIndex = 4;
+    else if (view.score >= 40) milestoneIndex = 3;
+    else if (view.score >= 20) milestoneIndex = 2;
+    else if (view.score >= 10) milestoneIndex = 1;
+    else if (view.score >= 5) milestoneIndex = 0;
+
+    // Draw celebration message with animation
+    float scale = 1.0f + 0.2f * sin(view.celebrationTimer * 10.0f);
+    float alpha = view.celebrationTimer / CELEBRATION_DURATION;
+
+    batchPushMatrix();
+    batchTranslatef(WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2);
+    batchScalef(scale, scale);
+
+    // Draw text background
+    batchColor4f(0.0f, 0.0f, 0.0f, alpha * 0.7f);
+    batchBegin(GL_QUADS);
+    batchVertex2f(-150, -50);
+    batchVertex2f(150, -50);
+    batchVertex2f(150, 50);
+    batchVertex2f(-150, 50);
+    batchEnd();
+
+    // Draw text with rainbow effect
+    const char* message = milestoneMessages[milestoneIndex];
+    int messageLength = strlen(message);
+    float x = -messageLength * 9;  // Approximate text width
+    
+    PROFILE_SCOPE(PROFILE_TEXT);
+    for (int i = 0; i < messageLength; i++) {
+        float colorIndex = (i + view.celebrationTimer * 5) / 5.0f;
+        int colorIdx = ((int)colorIndex) % 5;
+        batchColor4f(celebrationColors[colorIdx][0],
+                     celebrationColors[colorIdx][1],
+                     celebrationColors[colorIdx][2],
+                     alpha);
+        char glyph[2] = {message[i], '\0'};
+        batchText(x + i * 18, -10, glyph);
+    }
+
+    batchPopMatrix();
+}
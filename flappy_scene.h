@@ -0,0 +1,119 @@
+// Game scene
+// Game state, animation and all drawing, with no GLUT dependency: the game
+// drives it from its window callbacks, and offscreen tools render the same
+// frames into an EGL context.
+#ifndef FLAPPY_SCENE_H
+#define FLAPPY_SCENE_H
+
+#include "flappy_gl.h"
+#include "flappy_sim.h"
+#include "flappy_particles.h"
+#include "flappy_ghost.h"
+
+// Game States
+enum GameState {
+    MENU,
+    INSTRUCTIONS,
+    PLAYING,
+    GAME_OVER
+};
+
+extern GameState currentState;
+extern int menuSelection;
+
+extern SimState sim;
+extern SimState prevSim;  // State before the last tick
+extern SimState view;     // Interpolated state that the draw functions read
+extern bool flapQueued;   // Flap requested by input, applied on the next tick
+
+extern ParticlePool particles;
+extern int particleCapacity;  // Set before sceneInit()
+
+// Level shape (simSetLevel()) and collision rule (simSetSweptCollision())
+// of every run; set before sceneInit()
+extern int levelPipes;
+extern int levelSpacing;
+extern bool levelSwept;
+
+// Level file (flappy_level.h) whose pipes every run flies through, kept
+// open until the next sceneLoadLevel(); set before sceneInit(). False if
+// the file is missing, not a level file or fails levelVerify().
+bool sceneLoadLevel(const char* path);
+
+// Build the cached geometry and particle pool and start a world from seed
+// (the level and effects streams both start from it)
+void sceneInit(unsigned int seed);
+
+// Return to the start-up state (menu, fresh world, no particles) without
+// reallocating, e.g. between scripted sessions
+void sceneReset(unsigned int seed);
+
+// Free the textures the sky and ground are cached in (flappy_layer.h),
+// before the context goes away; the next frame builds them again
+void sceneFreeLayers();
+
+// Whether anything on screen moves at game speed without input: true
+// while playing (bird, pipes, celebrations) and while particles are live,
+// e.g. the crash burst on the game over screen. The sky
+// and clouds drift on every screen, but slowly enough for a lower frame
+// rate (Pacing in flappy_time.h).
+bool sceneBusy();
+
+// Advance the game by one fixed tick
+void tick();
+
+// Start a new round
+void resetGame();
+
+// Create particles at position
+void createParticles(float x, float y, float r, float g, float b);
+
+// Move, age and expire the particles by one tick (part of tick())
+void updateParticles();
+
+// Flap on the next tick, with the wing and particle effect of a key press
+void sceneFlap();
+
+// Input replays (flappy_replay.h). With sceneRecord(), every run that ends
+// is saved to path (the last one wins). After scenePlay(), runs started by
+// resetGame() take their seed and flaps from the file, and the end of the
+// run is checked against it; a replay of a level file needs that level
+// loaded (sceneLoadLevel()), else scenePlay() fails.
+void sceneRecord(const char* path);
+bool scenePlay(const char* path);
+extern bool replayPlaying;
+
+// Ghost racing (flappy_ghost.h). After sceneRace(), runs started by
+// resetGame() use the ghost set's seed and level, the set's finished runs
+// fly alongside the bird as translucent ghosts, and every run that ends
+// joins the set. With a path the set is loaded from it (or started empty
+// in the current level if there is no such file) and saved back after
+// every run; false if the file is not a ghost file, or its runs were not
+// played on the loaded level file (or on generated pipes if none is).
+bool sceneRace(const char* path);
+void sceneStopRace();
+extern GhostSet ghosts;
+extern bool racing;
+
+// Clear the frame and draw the current screen, then flush the batch.
+// timeMs drives the time-based animation (pulses), alpha interpolates
+// between the previous and current tick. The text atlas must be built.
+void sceneRender(int timeMs, float alpha);
+
+// The parts sceneRender() draws a screen from, for timing them one by one.
+// They read the view and clock of the last sceneRender() and only add to
+// the batch.
+void drawSky();
+void drawPipes();
+void drawBird();
+void drawParticles();
+void drawGround();
+void drawScore();
+void drawCelebration();
+void drawMenu();
+void drawInstructions();
+void drawGameOver();
+void drawGhosts();
+void drawBirdAt(float x, float y, float rotation);
+
+#endif
@@ -0,0 +1,64 @@
+#include "flappy_shader.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+bool shaderSupported() {
+    const char* version = (const char*)glGetString(GL_VERSION);
+    int major = 0, minor = 0;
+    if (!version || sscanf(version, "%d.%d", &major, &minor) != 2 || major < 2) {
+        return false;
+    }
+    const char* glsl = (const char*)glGetString(GL_SHADING_LANGUAGE_VERSION);
+    return glsl && sscanf(glsl, "%d.%d", &major, &minor) == 2 &&
+           (major > 1 || (major == 1 && minor >= 20));
+}
+
+// Compile one stage; 0 on failure
+static GLuint compile(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    GLint ok = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        printf("%s shader: %s\n", type == GL_VERTEX_SHADER ? "vertex" : "fragment", log);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+GLuint shaderProgram(const char* vertexSource, const char* fragmentSource,
+                     const char* const* attributes, int attributeCount) {
+    GLuint vertex = compile(GL_VERTEX_SHADER, vertexSource);
+    GLuint fragment = compile(GL_FRAGMENT_SHADER, fragmentSource);
+    if (!vertex || !fragment) {
+        if (vertex) glDeleteShader(vertex);
+        if (fragment) glDeleteShader(fragment);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    for (int i = 0; i < attributeCount; i++) {
+        glBindAttribLocation(program, i + 1, attributes[i]);
+    }
+    glLinkProgram(program);
+    // The program keeps the stages alive as long as it needs them
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+
+    GLint ok = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        glGetProgramInfoLog(program, sizeof(log), NULL, log);
+        printf("shader program: %s\n", log);
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
@@ -0,0 +1,21 @@
+// GLSL programs
+// Compiles and links GLSL 1.20 programs (OpenGL 2.1, the newest version
+// that keeps the fixed-function state the batch relies on, and what Mesa
+// llvmpipe and macOS legacy contexts provide). Callers fall back to the
+// fixed-function pipeline when shaderSupported() is false or a program
+// fails to build.
+#ifndef FLAPPY_SHADER_H
+#define FLAPPY_SHADER_H
+
+#include "flappy_gl.h"
+
+// Whether the current context runs GLSL 1.20 (OpenGL 2.0 or later)
+bool shaderSupported();
+
+// Compile and link a program; attributes[i] is bound to generic attribute
+// location i + 1 (0 stays gl_Vertex). Returns 0, printing the log, if
+// either stage fails.
+GLuint shaderProgram(const char* vertexSource, const char* fragmentSource,
+                     const char* const* attributes, int attributeCount);
+
+#endif
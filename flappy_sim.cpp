@@ -0,0 +1,378 @@
+#include "flappy_sim.h"
+#include "flappy_collide.h"
+#include "flappy_level.h"
+#include <stdlib.h>
+
+// Pick a random gap position within playable bounds
+float simRandomGapY(Random& rng) {
+    int minGapPos = 100;  // Minimum distance from top
+    int maxGapPos = WINDOW_HEIGHT - 150;  // Maximum distance from bottom (accounting for ground)
+    return minGapPos + randomRange(rng, maxGapPos - minGapPos);
+}
+
+// Initialize a fresh state
+void simInit(SimState& state, unsigned int seed) {
+    randomSeed(state.rng, seed, RANDOM_STREAM_LEVEL);
+    state.highScore = 0;
+    state.pipeCount = MAX_PIPES;
+    state.basePipeCount = MAX_PIPES;
+    state.pipeSpacing = PIPE_SPACING;
+    state.sweptCollision = false;
+    state.levelRecords = NULL;
+    state.levelLength = 0;
+    state.levelLoop = false;
+    state.levelWindow = 0;
+    simReset(state);
+}
+
+void simSetLevel(SimState& state, int pipeCount, int pipeSpacing) {
+    if (pipeCount < 1) pipeCount = 1;
+    if (pipeCount > SIM_PIPE_CAPACITY) pipeCount = SIM_PIPE_CAPACITY;
+    if (pipeSpacing < 1) pipeSpacing = 1;
+    if (pipeSpacing > SIM_MAX_PIPE_SPACING) pipeSpacing = SIM_MAX_PIPE_SPACING;
+    state.basePipeCount = pipeCount;
+    state.pipeCount = pipeCount > state.levelWindow ? pipeCount : state.levelWindow;
+    state.pipeSpacing = pipeSpacing;
+}
+
+void simSetSweptCollision(SimState& state, bool swept) {
+    state.sweptCollision = swept;
+}
+
+int simPipesToFill(int pipeSpacing) {
+    int count = (WINDOW_WIDTH + PIPE_WIDTH + pipeSpacing - 1) / pipeSpacing + 1;
+    return count > MAX_PIPES ? count : MAX_PIPES;
+}
+
+// Start a run from its own seed
+void simRestart(SimState& state, unsigned int seed) {
+    randomSeed(state.rng, seed, RANDOM_STREAM_LEVEL);
+    simReset(state);
+}
+
+// Set up pipe as the next pipe of the level, after the one at previousX
+// (the first of a run starts at the right edge): from the level file while
+// it lasts, else from the level stream
+static inline void nextPipe(SimState& state, Pipe& pipe, float previousX, bool first) {
+    if (state.levelNext < state.levelLength) {
+        const LevelPipe& record = state.levelRecords[state.levelNext];
+        float spacing = record.spacing > 0 ? record.spacing : 1;
+        pipe.x = first ? WINDOW_WIDTH : previousX + spacing;
+        pipe.gapY = record.gapY;
+        pipe.gap = record.gap > 0 ? record.gap : PIPE_GAP;
+        if (++state.levelNext == state.levelLength && state.levelLoop) {
+            state.levelNext = 0;
+        }
+    } else {
+        pipe.x = first ? WINDOW_WIDTH : previousX + state.pipeSpacing;
+        pipe.gapY = simRandomGapY(state.rng);
+        pipe.gap = PIPE_GAP;
+    }
+    pipe.counted = false;
+}
+
+// Reset game
+void simReset(SimState& state) {
+    state.birdX = WINDOW_WIDTH / 4;
+    state.birdY = WINDOW_HEIGHT / 2;
+    state.birdVelocity = 0;
+    state.birdRotation = 0;
+    state.score = 0;
+
+    state.lastMilestone = 0;
+    state.celebrationTimer = 0.0f;
+    state.isCelebrating = false;
+
+    state.dead = false;
+    state.tick = 0;
+
+    // Reset pipes with proper spacing
+    state.pipeHead = 0;
+    state.scroll = 0;
+    state.levelNext = 0;
+    for (int i = 0; i < state.pipeCount; i++) {
+        nextPipe(state, state.pipes[i], i > 0 ? state.pipes[i - 1].x : 0, i == 0);
+    }
+}
+
+// Rules shared by simStep() and simSnapshotStep()
+
+static inline void stepBird(float& y, float& velocity, bool flap) {
+    if (flap) {
+        velocity = FLAP_VELOCITY;
+    }
+    velocity += GRAVITY;
+    y += velocity;
+}
+
+static inline float birdRotation(float velocity) {
+    float rotation = velocity * 3;
+    if (rotation > 60) rotation = 60;
+    if (rotation < -60) rotation = -60;
+    return rotation;
+}
+
+static inline bool outOfBounds(float y) {
+    return y < 0 || y > WINDOW_HEIGHT - GROUND_HEIGHT;
+}
+
+// Box of +-BIRD_SIZE against the body of the pipe at screen x
+static inline bool boxHitsPipe(float x, float gapY, float gap, float birdX, float birdY) {
+    return x < birdX + BIRD_SIZE && x + PIPE_WIDTH > birdX - BIRD_SIZE &&
+           (birdY - BIRD_SIZE < gapY - gap/2 || birdY + BIRD_SIZE > gapY + gap/2);
+}
+
+// Body and cap rectangles of the pipe at screen x
+static inline void pipeRects(float x, float gapY, float gap, CollideRect* rects) {
+    float gapTop = gapY - gap/2;
+    float gapBottom = gapY + gap/2;
+    CollideRect pipe[4] = {
+        {x, -WINDOW_HEIGHT, x + PIPE_WIDTH, gapTop},  // Up past the top of the screen
+        {x - PIPE_CAP_OVERHANG, gapTop - PIPE_CAP_HEIGHT,
+         x + PIPE_WIDTH + PIPE_CAP_OVERHANG, gapTop},
+        {x - PIPE_CAP_OVERHANG, gapBottom,
+         x + PIPE_WIDTH + PIPE_CAP_OVERHANG, gapBottom + PIPE_CAP_HEIGHT},
+        {x, gapBottom, x + PIPE_WIDTH, WINDOW_HEIGHT}
+    };
+    for (int r = 0; r < 4; r++) {
+        rects[r] = pipe[r];
+    }
+}
+
+// Reset the leftmost pipe once it goes off screen, after the rightmost
+void simRecyclePipes(SimState& state) {
+    while (simPipeX(state, state.pipes[state.pipeHead]) + PIPE_WIDTH < 0) {
+        int tail = (state.pipeHead > 0 ? state.pipeHead : state.pipeCount) - 1;
+        nextPipe(state, state.pipes[state.pipeHead], state.pipes[tail].x, false);
+        state.pipeHead = state.pipeHead + 1 < state.pipeCount ? state.pipeHead + 1 : 0;
+    }
+}
+
+// Advance the game by one tick
+SimEvents simStep(SimState& state, const SimInput& input) {
+    SimEvents events = {false, false, false};
+    if (state.dead) {
+        return events;
+    }
+
+    // Check for milestones
+    if (state.score > state.lastMilestone) {
+        int s = state.score;
+        if (s == 5 || s == 10 || s == 20 || s == 40 || s == 80) {
+            state.lastMilestone = s;
+            state.isCelebrating = true;
+            state.celebrationTimer = CELEBRATION_DURATION;
+            events.milestone = true;
+        }
+    }
+
+    // Update celebration timer
+    if (state.isCelebrating) {
+        state.celebrationTimer -= SIM_DT;
+        if (state.celebrationTimer <= 0) {
+            state.isCelebrating = false;
+        }
+    }
+
+    // Update bird position
+    float fromY = state.birdY;
+    stepBird(state.birdY, state.birdVelocity, input.flap);
+
+    // Update bird rotation
+    state.birdRotation = birdRotation(state.birdVelocity);
+
+    // Scroll the level; the pipes stay put in level coordinates
+    state.scroll += PIPE_SPEED;
+
+    // Check if bird passed a pipe: only pipes left of the bird can have
+    for (int k = 0, i = state.pipeHead; k < state.pipeCount; k++) {
+        Pipe& pipe = state.pipes[i];
+        if (simPipeX(state, pipe) + PIPE_WIDTH >= state.birdX) {
+            break;
+        }
+        if (!pipe.counted) {
+            state.score++;
+            pipe.counted = true;
+            events.scored = true;
+
+            // Update high score
+            if (state.score > state.highScore) {
+                state.highScore = state.score;
+            }
+        }
+        i = i + 1 < state.pipeCount ? i + 1 : 0;
+    }
+
+    simRecyclePipes(state);
+
+    // Keep level coordinates small (once every few minutes)
+    if (state.scroll >= SIM_SCROLL_REBASE) {
+        state.scroll -= SIM_SCROLL_REBASE;
+        for (int i = 0; i < state.pipeCount; i++) {
+            state.pipes[i].x -= SIM_SCROLL_REBASE;
+        }
+    }
+
+    // Check for collisions
+    bool hitPipe = state.sweptCollision ? simCheckSweptCollision(state, fromY, PIPE_SPEED)
+                                        : simCheckCollision(state);
+    if (hitPipe || outOfBounds(state.birdY)) {
+        state.dead = true;
+        events.died = true;
+    }
+
+    state.tick++;
+    return events;
+}
+
+// Check for collisions against the pipes that overlap the bird
+bool simCheckCollision(const SimState& state) {
+    for (int k = 0; k < state.pipeCount; k++) {
+        const Pipe& pipe = simPipe(state, k);
+        float x = simPipeX(state, pipe);
+        if (x >= state.birdX + BIRD_SIZE) {
+            break;  // This pipe and the rest are ahead of the bird
+        }
+        if (boxHitsPipe(x, pipe.gapY, pipe.gap, state.birdX, state.birdY)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Body and cap rectangles, on screen, of the pipes that reach into
+// [minX, maxX); returns how many were written (4 per pipe)
+static int gatherPipeRects(const SimState& state, float minX, float maxX, CollideRect* rects) {
+    int count = 0;
+    for (int k = 0; k < state.pipeCount; k++) {
+        const Pipe& pipe = simPipe(state, k);
+        float x = simPipeX(state, pipe);
+        if (x - PIPE_CAP_OVERHANG >= maxX) {
+            break;
+        }
+        if (x + PIPE_WIDTH + PIPE_CAP_OVERHANG <= minX) {
+            continue;
+        }
+        pipeRects(x, pipe.gapY, pipe.gap, rects + count);
+        count += 4;
+    }
+    return count;
+}
+
+bool simCheckSweptCollision(const SimState& state, float fromY, float scrolled) {
+    bool hit;
+    simCheckSweptCollisions(state, scrolled, &fromY, &state.birdY, &state.birdRotation, 1, &hit);
+    return hit;
+}
+
+int simCheckSweptCollisions(const SimState& state, float scrolled, const float* fromY,
+                            const float* toY, const float* rotation, int count, bool* hit) {
+    // Pipes within reach of any bird along the sweep; relative to the
+    // pipes, the birds moved right by scrolled
+    CollideRect rects[SIM_PIPE_CAPACITY * 4];
+    float reach = BIRD_RADIUS_X > BIRD_RADIUS_Y ? BIRD_RADIUS_X : BIRD_RADIUS_Y;
+    int rectCount = gatherPipeRects(state, state.birdX - scrolled - reach, state.birdX + reach, rects);
+
+    int hits = 0;
+    for (int i = 0; i < count; i++) {
+        CollideSweep sweep = {
+            state.birdX - scrolled, fromY[i], state.birdX, toY[i],
+            BIRD_RADIUS_X, BIRD_RADIUS_Y, rotation[i]
+        };
+        hit[i] = rectCount > 0 && collideSweptEllipse(sweep, rects, rectCount);
+        hits += hit[i];
+    }
+    return hits;
+}
+
+const Pipe* simNextPipe(const SimState& state) {
+    for (int k = 0; k < state.pipeCount; k++) {
+        const Pipe& pipe = simPipe(state, k);
+        if (simPipeX(state, pipe) + PIPE_WIDTH >= state.birdX - BIRD_SIZE) {
+            return &pipe;
+        }
+    }
+    return NULL;
+}
+
+void simSnapshotTake(const SimState& state, SimSnapshot& snapshot) {
+    int count = state.pipeCount < SIM_SNAPSHOT_PIPES ? state.pipeCount : SIM_SNAPSHOT_PIPES;
+    snapshot.birdY = state.birdY;
+    snapshot.birdVelocity = state.birdVelocity;
+    snapshot.pipeCounted = 0;
+    for (int k = 0; k < count; k++) {
+        const Pipe& pipe = simPipe(state, k);
+        snapshot.pipeX[k] = simPipeX(state, pipe);
+        snapshot.pipeGapY[k] = pipe.gapY;
+        snapshot.pipeGap[k] = pipe.gap;
+        if (pipe.counted) {
+            snapshot.pipeCounted |= 1u << k;
+        }
+    }
+    snapshot.pipeCount = (unsigned char)count;
+    snapshot.pipeHead = 0;
+    snapshot.recycle = state.pipeCount <= SIM_SNAPSHOT_PIPES && state.levelLength == 0;
+    snapshot.sweptCollision = state.sweptCollision;
+    snapshot.dead = state.dead;
+    snapshot.pipeSpacing = state.pipeSpacing;
+    snapshot.score = state.score;
+    snapshot.tick = state.tick;
+    snapshot.rng = state.rng;
+}
+
+bool simSnapshotStep(SimSnapshot& s, bool flap) {
+    if (s.dead) {
+        return false;
+    }
+    const float birdX = WINDOW_WIDTH / 4;
+    float fromY = s.birdY;
+    stepBird(s.birdY, s.birdVelocity, flap);
+
+    // Scroll, then score, recycle and collide in the same order as simStep()
+    int n = s.pipeCount;
+    for (int i = 0; i < n; i++) {
+        s.pipeX[i] -= PIPE_SPEED;
+    }
+    for (int k = 0, i = s.pipeHead; k < n && s.pipeX[i] + PIPE_WIDTH < birdX; k++) {
+        if (!(s.pipeCounted & (1u << i))) {
+            s.score++;
+            s.pipeCounted |= 1u << i;
+        }
+        i = i + 1 < n ? i + 1 : 0;
+    }
+    while (s.recycle && s.pipeX[s.pipeHead] + PIPE_WIDTH < 0) {
+        int tail = (s.pipeHead > 0 ? s.pipeHead : n) - 1;
+        s.pipeX[s.pipeHead] = s.pipeX[tail] + s.pipeSpacing;
+        s.pipeGapY[s.pipeHead] = simRandomGapY(s.rng);
+        s.pipeGap[s.pipeHead] = PIPE_GAP;
+        s.pipeCounted &= ~(1u << s.pipeHead);
+        s.pipeHead = s.pipeHead + 1 < n ? s.pipeHead + 1 : 0;
+    }
+
+    bool hit = outOfBounds(s.birdY);
+    if (s.sweptCollision) {
+        CollideRect rects[SIM_SNAPSHOT_PIPES * 4];
+        int count = 0;
+        float reach = BIRD_RADIUS_X > BIRD_RADIUS_Y ? BIRD_RADIUS_X : BIRD_RADIUS_Y;
+        for (int i = 0; i < n; i++) {
+            if (s.pipeX[i] - PIPE_CAP_OVERHANG < birdX + reach &&
+                s.pipeX[i] + PIPE_WIDTH + PIPE_CAP_OVERHANG > birdX - PIPE_SPEED - reach) {
+                pipeRects(s.pipeX[i], s.pipeGapY[i], s.pipeGap[i], rects + count);
+                count += 4;
+            }
+        }
+        CollideSweep sweep = {
+            birdX - PIPE_SPEED, fromY, birdX, s.birdY,
+            BIRD_RADIUS_X, BIRD_RADIUS_Y, birdRotation(s.birdVelocity)
+        };
+        hit = hit || (count > 0 && collideSweptEllipse(sweep, rects, count));
+    } else {
+        for (int i = 0; i < n && !hit; i++) {
+            hit = boxHitsPipe(s.pipeX[i], s.pipeGapY[i], s.pipeGap[i], birdX, s.birdY);
+        }
+    }
+    s.dead = hit;
+    s.tick++;
+    return hit;
+}
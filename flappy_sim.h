@@ -0,0 +1,204 @@
+// Headless simulation core
+// Bird physics, pipe scrolling/recycling, scoring and collision without any
+// OpenGL/GLUT dependency, so the game can be stepped without a window.
+#ifndef FLAPPY_SIM_H
+#define FLAPPY_SIM_H
+
+#include "flappy_random.h"
+
+// Game Constants
+#define WINDOW_WIDTH 800
+#define WINDOW_HEIGHT 600
+#define PIPE_WIDTH 60
+#define PIPE_GAP 150  // Gap between top and bottom pipe (vertical space for bird)
+#define PIPE_SPACING 300  // Horizontal spacing between pipe sets
+#define BIRD_SIZE 30
+#define GRAVITY 0.25
+#define FLAP_VELOCITY -5.0
+#define PIPE_SPEED 2.5
+#define GROUND_HEIGHT 50
+#define PIPE_CAP_OVERHANG 5  // Cap lip beyond each side of the pipe
+#define PIPE_CAP_HEIGHT 20
+#define BIRD_RADIUS_X (BIRD_SIZE * 1.2f)  // Body ellipse as drawn
+#define BIRD_RADIUS_Y BIRD_SIZE
+
+// Simulation tick length in seconds (one update() at 16 ms)
+#define SIM_DT 0.016f
+
+#define CELEBRATION_DURATION 2.0f  // Duration in seconds
+
+// Pipe Properties
+struct Pipe {
+    float x;  // Left edge in level coordinates, on screen at x - SimState::scroll
+    float gapY;
+    float gap;  // Gap height, PIPE_GAP unless a level file says otherwise
+    bool counted;
+};
+
+struct LevelPipe;  // flappy_level.h
+
+const int MAX_PIPES = 5;  // Pipes alive in the default level
+
+// Pipe storage per state: the most pipes a level can keep alive
+#ifndef SIM_PIPE_CAPACITY
+#define SIM_PIPE_CAPACITY 256
+#endif
+
+// Widest pipe spacing a level can use
+#define SIM_MAX_PIPE_SPACING (WINDOW_WIDTH * 16)
+
+// Scroll distance after which level coordinates are shifted back by this
+// much. Positions are multiples of 0.5, so they stay exact in float.
+#define SIM_SCROLL_REBASE 65536.0f
+
+// Complete game state for one bird; plain data so it can be copied freely
+struct SimState {
+    // Bird Properties
+    float birdX;
+    float birdY;
+    float birdVelocity;
+    float birdRotation;
+
+    // Ring of pipeCount pipes sorted left to right, the leftmost at
+    // pipeHead; a pipe that leaves the screen is moved after the last one
+    Pipe pipes[SIM_PIPE_CAPACITY];
+    int pipeCount;      // The larger of basePipeCount and levelWindow
+    int basePipeCount;  // Set by simSetLevel()
+    int pipeHead;
+    float pipeSpacing;
+    float scroll;  // Distance the level has scrolled (see SIM_SCROLL_REBASE)
+    bool sweptCollision;  // See simSetSweptCollision()
+
+    int score;
+    int highScore;
+
+    // Milestone tracking
+    int lastMilestone;
+    float celebrationTimer;
+    bool isCelebrating;
+
+    bool dead;
+    unsigned int tick;
+    Random rng;  // Level stream, for pipe gaps
+
+    // Level file records streamed into the ring, if any (see
+    // simSetLevelFile() in flappy_level.h)
+    const LevelPipe* levelRecords;
+    unsigned int levelLength;
+    unsigned int levelNext;  // Record of the next pipe to come in
+    bool levelLoop;
+    int levelWindow;         // Pipes the level file needs alive, 0 for none
+};
+
+// Compact copy of the rules-relevant part of a state, for searching ahead:
+// under two hundred bytes, trivially copyable, so a search can clone it
+// into a fixed node pool with no allocation. It holds the first
+// SIM_SNAPSHOT_PIPES pipes in screen coordinates. If the level is
+// generated and has no more than that, pipes recycle as in simStep() and
+// the snapshot steps exactly like the state; otherwise the pipes past the
+// window are missing, so lookahead is exact only until the window runs out
+// (at least SIM_SNAPSHOT_PIPES spacings ahead).
+#define SIM_SNAPSHOT_PIPES 8
+
+struct SimSnapshot {
+    float birdY;
+    float birdVelocity;
+    float pipeX[SIM_SNAPSHOT_PIPES];  // Screen x of the k-th pipe from pipeHead
+    float pipeGapY[SIM_SNAPSHOT_PIPES];
+    float pipeGap[SIM_SNAPSHOT_PIPES];
+    unsigned int pipeCounted;          // Bit k: pipe k was passed
+    unsigned char pipeCount;
+    unsigned char pipeHead;
+    bool recycle;                      // Whole level in the window
+    bool sweptCollision;
+    bool dead;
+    float pipeSpacing;
+    int score;
+    unsigned int tick;
+    Random rng;
+};
+
+// Player input for a single tick
+struct SimInput {
+    bool flap;
+};
+
+// What happened during a tick, for the presentation layer to react to
+struct SimEvents {
+    bool scored;
+    bool milestone;
+    bool died;
+};
+
+// Initialize a fresh state (clears the high score) in the default level
+void simInit(SimState& state, unsigned int seed);
+
+// Level shape for the next reset: pipeCount pipes alive (at most
+// SIM_PIPE_CAPACITY, and at least an attached level file's window),
+// pipeSpacing pixels apart (at most SIM_MAX_PIPE_SPACING)
+void simSetLevel(SimState& state, int pipeCount, int pipeSpacing);
+
+// Collision rule for the following steps: the default tests a box of
+// +-BIRD_SIZE around the bird against the pipe bodies after each step;
+// swept collision tests the drawn body ellipse along its whole move against
+// the pipes and their caps (flappy_collide.h)
+void simSetSweptCollision(SimState& state, bool swept);
+
+// Fewest pipes that keep the screen filled at this spacing (at least
+// MAX_PIPES)
+int simPipesToFill(int pipeSpacing);
+
+// Start a new run, keeping the high score
+void simReset(SimState& state);
+
+// Start a new run with the level stream restarted from seed, keeping the
+// high score; the pipes come out as after simInit(state, seed)
+void simRestart(SimState& state, unsigned int seed);
+
+// Advance the game by one tick
+SimEvents simStep(SimState& state, const SimInput& input);
+
+// Move every pipe that has scrolled off the left edge after the last one,
+// as the next pipe of the level (part of simStep())
+void simRecyclePipes(SimState& state);
+
+// Check the bird against the pipes
+bool simCheckCollision(const SimState& state);
+
+// Check the bird's ellipse, which moved from fromY to birdY while the
+// pipes scrolled by scrolled, against the pipes and caps it swept past
+bool simCheckSweptCollision(const SimState& state, float fromY, float scrolled);
+
+// The same for count birds at birdX that share state's pipes: bird i moved
+// from fromY[i] to toY[i] and ends at rotation[i] degrees. The pipes near
+// the birds are gathered once for all of them. Sets hit[i] and returns the
+// number of hits.
+int simCheckSweptCollisions(const SimState& state, float scrolled, const float* fromY,
+                            const float* toY, const float* rotation, int count, bool* hit);
+
+// Copy the rules-relevant part of state
+void simSnapshotTake(const SimState& state, SimSnapshot& snapshot);
+
+// simStep() on a snapshot, without milestones or events; returns whether
+// the bird died on this step
+bool simSnapshotStep(SimSnapshot& snapshot, bool flap);
+
+// k-th pipe from the left
+static inline const Pipe& simPipe(const SimState& state, int k) {
+    int i = state.pipeHead + k;
+    return state.pipes[i < state.pipeCount ? i : i - state.pipeCount];
+}
+
+// Screen x of a pipe's left edge
+static inline float simPipeX(const SimState& state, const Pipe& pipe) {
+    return pipe.x - state.scroll;
+}
+
+// Leftmost pipe whose right edge is not yet behind the bird's left edge,
+// i.e. the next one to fly through
+const Pipe* simNextPipe(const SimState& state);
+
+// Next pipe gap position from the level stream
+float simRandomGapY(Random& rng);
+
+#endif
@@ -0,0 +1,465 @@
+// Headless simulation benchmark
+// Steps the simulation core as fast as possible with a simple scripted bot
+// and reports throughput in millions of ticks per second.
+//
+// Usage: flappy_sim_bench [ticks]
+//        flappy_sim_bench --batch WORLDS [ticks]   batched vs scalar worlds
+//        flappy_sim_bench --verify WORLDS [ticks]  check batch == simStep()
+//        flappy_sim_bench --stress [seconds]       fixed timestep under frame spikes
+//        flappy_sim_bench --levels [ticks]         throughput by pipe count and spacing
+//        flappy_sim_bench --collide [cases]        swept collision vs sampled reference
+//        flappy_sim_bench --lookahead [runs] [beam] [depth]   beam-search autopilot
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include "flappy_sim.h"
+#include "flappy_batch.h"
+#include "flappy_collide.h"
+#include "flappy_lookahead.h"
+#include "flappy_time.h"
+
+// Scripted bot: flap when falling below the centre of the next gap
+static bool botWantsFlap(const SimState& state) {
+    const Pipe* next = simNextPipe(state);
+    float targetY = next ? next->gapY + 10 : WINDOW_HEIGHT / 2;
+    return state.birdY > targetY && state.birdVelocity >= 0;
+}
+
+// Cheap stateless flap pattern shared by the batched and scalar runs
+static bool patternFlap(int world, long tick, float birdY, float birdVelocity) {
+    unsigned int h = (unsigned int)world * 2654435761u ^ (unsigned int)tick * 40503u;
+    return birdY > 300 + (h >> 27) * 4 && birdVelocity >= 0;
+}
+
+// Single world with the scripted bot
+static int benchSingle(long ticks) {
+    SimState state;
+    simInit(state, 12345);
+
+    long runs = 0;
+    long totalScore = 0;
+    double start = timeNow();
+    for (long t = 0; t < ticks; t++) {
+        SimInput input = { botWantsFlap(state) };
+        SimEvents events = simStep(state, input);
+        if (events.died) {
+            runs++;
+            totalScore += state.score;
+            simReset(state);
+        }
+    }
+    double elapsed = timeNow() - start;
+
+    printf("ticks:        %ld\n", ticks);
+    printf("elapsed:      %.3f s\n", elapsed);
+    printf("throughput:   %.2f Mticks/s\n", ticks / elapsed / 1e6);
+    printf("runs:         %ld\n", runs);
+    printf("avg score:    %.2f\n", runs ? (double)totalScore / runs : (double)state.score);
+    printf("high score:   %d\n", state.highScore);
+    return 0;
+}
+
+// Single-world throughput in default, wide and dense levels; with the pipe
+// ring it should not depend on how many pipes are alive
+static int benchLevels(long ticks) {
+    static const int levels[][2] = {
+        {MAX_PIPES, PIPE_SPACING}, {SIM_PIPE_CAPACITY, PIPE_SPACING},
+        {simPipesToFill(120), 120}, {SIM_PIPE_CAPACITY, 120}
+    };
+    printf("pipes  spacing  Mticks/s  avg score\n");
+    for (int l = 0; l < (int)(sizeof(levels) / sizeof(levels[0])); l++) {
+        SimState state;
+        simInit(state, 12345);
+        simSetLevel(state, levels[l][0], levels[l][1]);
+        simReset(state);
+
+        long runs = 0;
+        long totalScore = 0;
+        double start = timeNow();
+        for (long t = 0; t < ticks; t++) {
+            SimInput input = { botWantsFlap(state) };
+            if (simStep(state, input).died) {
+                runs++;
+                totalScore += state.score;
+                simReset(state);
+            }
+        }
+        double elapsed = timeNow() - start;
+        printf("%5d  %7d  %8.2f  %9.2f\n", state.pipeCount, levels[l][1], ticks / elapsed / 1e6,
+               runs ? (double)totalScore / runs : (double)state.score);
+    }
+    return 0;
+}
+
+// Uniform float in [low, high) at 1/1024 resolution
+static float randomFloat(Random& rng, float low, float high) {
+    return low + (high - low) * randomRange(rng, 1024) / 1024.0f;
+}
+
+// Random large moves past a pipe: the swept test must catch every overlap
+// that a 256-step sampling of the path finds, and the end-position test
+// shows how many it would have missed. Then time the scalar and batched
+// tests on real states.
+static int benchCollide(int cases) {
+    const int samples = 256;
+    const float birdX = WINDOW_WIDTH / 4;
+    Random rng;
+    randomSeed(rng, 7, 0);
+
+    int sweptHits = 0, sampledHits = 0, missed = 0, endHits = 0;
+    for (int c = 0; c < cases; c++) {
+        float x = birdX + randomFloat(rng, -120, 80);
+        float gapY = randomFloat(rng, 150, 400);
+        CollideRect rects[4] = {
+            {x, -WINDOW_HEIGHT, x + PIPE_WIDTH, gapY - PIPE_GAP/2},
+            {x - PIPE_CAP_OVERHANG, gapY - PIPE_GAP/2 - PIPE_CAP_HEIGHT,
+             x + PIPE_WIDTH + PIPE_CAP_OVERHANG, gapY - PIPE_GAP/2},
+            {x - PIPE_CAP_OVERHANG, gapY + PIPE_GAP/2,
+             x + PIPE_WIDTH + PIPE_CAP_OVERHANG, gapY + PIPE_GAP/2 + PIPE_CAP_HEIGHT},
+            {x, gapY + PIPE_GAP/2, x + PIPE_WIDTH, WINDOW_HEIGHT}
+        };
+        CollideSweep sweep = {
+            birdX - randomFloat(rng, 0, 60), randomFloat(rng, 0, 550),
+            birdX, randomFloat(rng, 0, 550),
+            BIRD_RADIUS_X, BIRD_RADIUS_Y, randomFloat(rng, -60, 60)
+        };
+        bool swept = collideSweptEllipse(sweep, rects, 4);
+
+        CollideSweep at = sweep;
+        at.fromX = sweep.toX;
+        at.fromY = sweep.toY;
+        bool end = collideSweptEllipse(at, rects, 4);
+        bool sampled = end;
+        for (int i = 0; i < samples && !sampled; i++) {
+            float t = (float)i / samples;
+            at.fromX = at.toX = sweep.fromX + (sweep.toX - sweep.fromX) * t;
+            at.fromY = at.toY = sweep.fromY + (sweep.toY - sweep.fromY) * t;
+            sampled = collideSweptEllipse(at, rects, 4);
+        }
+        sweptHits += swept;
+        sampledHits += sampled;
+        missed += sampled && !swept;
+        endHits += end;
+    }
+    printf("cases:        %d\n", cases);
+    printf("swept hits:   %d (sampled %d, missed by sweep %d)\n", sweptHits, sampledHits, missed);
+    printf("end hits:     %d (%d tunneled past the end-position test)\n", endHits, sweptHits - endHits);
+
+    // Step cost of each rule with the scripted bot
+    const long ticks = 2000000;
+    for (int rule = 0; rule < 2; rule++) {
+        SimState state;
+        simInit(state, 12345);
+        simSetSweptCollision(state, rule == 1);
+        long runs = 0;
+        double start = timeNow();
+        for (long t = 0; t < ticks; t++) {
+            SimInput input = { botWantsFlap(state) };
+            if (simStep(state, input).died) {
+                runs++;
+                simReset(state);
+            }
+        }
+        double elapsed = timeNow() - start;
+        printf("%-13s %.2f Mticks/s, %ld runs\n", rule ? "swept step:" : "box step:",
+               ticks / elapsed / 1e6, runs);
+    }
+
+    // Many birds against one pipe window
+    const int birds = 4096;
+    const int rounds = 200;
+    float* fromY = (float*)malloc(birds * sizeof(float));
+    float* toY = (float*)malloc(birds * sizeof(float));
+    float* rotation = (float*)malloc(birds * sizeof(float));
+    bool* hit = (bool*)malloc(birds * sizeof(bool));
+    SimState state;
+    simInit(state, 12345);
+    while (simPipeX(state, simPipe(state, 0)) > state.birdX) {
+        state.scroll += PIPE_SPEED;  // Bring the first pipe up to the birds
+    }
+    for (int i = 0; i < birds; i++) {
+        toY[i] = randomFloat(rng, 0, 550);
+        fromY[i] = toY[i] + randomFloat(rng, -20, 20);
+        rotation[i] = randomFloat(rng, -60, 60);
+    }
+    long hits = 0;
+    double start = timeNow();
+    for (int r = 0; r < rounds; r++) {
+        hits += simCheckSweptCollisions(state, PIPE_SPEED, fromY, toY, rotation, birds, hit);
+    }
+    double elapsed = timeNow() - start;
+    printf("batched:      %.1f ns per bird (%d birds, %.1f%% hit)\n",
+           elapsed / ((double)birds * rounds) * 1e9, birds, 100.0 * hits / ((double)birds * rounds));
+    free(fromY);
+    free(toY);
+    free(rotation);
+    free(hit);
+    return missed == 0 ? 0 : 1;
+}
+
+// Whether a snapshot of before, stepped with flap, matches after
+static bool snapshotMatches(const SimState& before, bool flap, const SimState& after) {
+    SimSnapshot snapshot;
+    simSnapshotTake(before, snapshot);
+    simSnapshotStep(snapshot, flap);
+    bool same = snapshot.birdY == after.birdY && snapshot.birdVelocity == after.birdVelocity &&
+                snapshot.score == after.score && snapshot.dead == after.dead &&
+                snapshot.tick == after.tick;
+    for (int k = 0; k < snapshot.pipeCount && same; k++) {
+        int i = (snapshot.pipeHead + k) % snapshot.pipeCount;
+        const Pipe& pipe = simPipe(after, k);
+        same = snapshot.pipeX[i] == simPipeX(after, pipe) && snapshot.pipeGapY[i] == pipe.gapY;
+    }
+    return same;
+}
+
+// Play runs with the lookahead autopilot, each up to a tick cap, and report
+// how many survive and how fast the search expands nodes. Every step is
+// also replayed on a snapshot to check it follows simStep() exactly.
+static int benchLookahead(int runs, int beamWidth, int depth) {
+    const unsigned int maxTicks = 6000;  // 50 pipes
+    Lookahead search;
+    if (!lookaheadInit(search, beamWidth, depth)) {
+        printf("out of memory for beam %d\n", beamWidth);
+        return 1;
+    }
+
+    int survived = 0;
+    long totalScore = 0, mismatches = 0;
+    double searchTime = 0, worstDecision = 0;
+    for (int run = 0; run < runs; run++) {
+        SimState state;
+        simInit(state, 1 + run);
+        simSetSweptCollision(state, run % 2 == 1);  // Both collision rules
+        simRestart(state, 1 + run);
+        while (!state.dead && state.tick < maxTicks) {
+            double start = timeNow();
+            SimInput input = { lookaheadWantsFlap(search, state) };
+            double elapsed = timeNow() - start;
+            searchTime += elapsed;
+            worstDecision = std::max(worstDecision, elapsed);
+
+            SimState before = state;
+            simStep(state, input);
+            mismatches += !snapshotMatches(before, input.flap, state);
+        }
+        survived += !state.dead;
+        totalScore += state.score;
+    }
+
+    printf("runs:         %d of %d survived %u ticks (%.1f%%)\n", survived, runs, maxTicks,
+           100.0 * survived / runs);
+    printf("avg score:    %.1f\n", (double)totalScore / runs);
+    printf("search:       beam %d, depth %d\n", search.beamWidth, search.depth);
+    printf("nodes:        %.2f M expanded/s, %.0f per decision\n",
+           search.nodesExpanded / searchTime / 1e6, (double)search.nodesExpanded / search.decisions);
+    printf("decision:     %.3f ms avg, %.3f ms max (frame budget 16 ms)\n",
+           searchTime / search.decisions * 1000, worstDecision * 1000);
+    printf("snapshot:     %ld mismatches\n", mismatches);
+    lookaheadFree(search);
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Many worlds stepped by simBatchStep(), optionally checked against simStep()
+static int benchBatch(int worlds, long ticks, bool verify) {
+    if (worlds < 1) {
+        printf("need at least one world\n");
+        return 1;
+    }
+    unsigned int* seeds = (unsigned int*)malloc(worlds * sizeof(unsigned int));
+    SimState* states = (SimState*)malloc(worlds * sizeof(SimState));
+    SimBatch batch;
+    if (!seeds || !states) {
+        printf("out of memory for %d worlds\n", worlds);
+        free(seeds);
+        free(states);
+        return 1;
+    }
+    for (int w = 0; w < worlds; w++) {
+        seeds[w] = 1000 + w;
+    }
+    if (!simBatchInit(batch, worlds, seeds)) {
+        printf("out of memory for %d worlds\n", worlds);
+        free(seeds);
+        free(states);
+        return 1;
+    }
+
+    for (int w = 0; w < worlds; w++) {
+        simInit(states[w], seeds[w]);
+    }
+
+    // Batched run
+    long mismatches = 0;
+    double batchTime = 0;
+    for (long t = 0; t < ticks; t++) {
+        for (int w = 0; w < worlds; w++) {
+            batch.flap[w] = patternFlap(w, t, batch.birdY[w], batch.birdVelocity[w]);
+        }
+
+        double start = timeNow();
+        simBatchStep(batch);
+        batchTime += timeNow() - start;
+
+        if (verify) {
+            for (int w = 0; w < worlds; w++) {
+                SimInput input = { patternFlap(w, t, states[w].birdY, states[w].birdVelocity) };
+                simStep(states[w], input);
+
+                SimState got;
+                simBatchGetWorld(batch, w, got);
+                bool same = got.birdY == states[w].birdY &&
+                            got.birdVelocity == states[w].birdVelocity &&
+                            got.score == states[w].score &&
+                            got.highScore == states[w].highScore &&
+                            got.dead == states[w].dead &&
+                            got.rng.state == states[w].rng.state;
+                for (int k = 0; k < MAX_PIPES; k++) {
+                    const Pipe& a = simPipe(got, k);
+                    const Pipe& b = simPipe(states[w], k);
+                    same = same && simPipeX(got, a) == simPipeX(states[w], b) &&
+                           a.gapY == b.gapY && a.counted == b.counted;
+                }
+                if (!same) {
+                    if (mismatches == 0) {
+                        printf("mismatch: world %d tick %ld\n", w, t);
+                    }
+                    mismatches++;
+                }
+                if (states[w].dead) {
+                    simReset(states[w]);
+                }
+            }
+        }
+
+        // Respawn finished worlds
+        for (int w = 0; w < worlds; w++) {
+            if (batch.dead[w]) {
+                simBatchResetWorld(batch, w);
+            }
+        }
+    }
+
+    printf("backend:      %s\n", simBatchBackend());
+    printf("worlds:       %d\n", worlds);
+    printf("ticks:        %ld\n", ticks);
+    printf("batch step:   %.2f Mworld-ticks/s\n", (double)worlds * ticks / batchTime / 1e6);
+
+    if (verify) {
+        printf("mismatches:   %ld\n", mismatches);
+    } else {
+        // Scalar reference on the same workload
+        double scalarTime = 0;
+        for (long t = 0; t < ticks; t++) {
+            double start = timeNow();
+            for (int w = 0; w < worlds; w++) {
+                SimInput input = { patternFlap(w, t, states[w].birdY, states[w].birdVelocity) };
+                simStep(states[w], input);
+            }
+            scalarTime += timeNow() - start;
+            for (int w = 0; w < worlds; w++) {
+                if (states[w].dead) {
+                    simReset(states[w]);
+                }
+            }
+        }
+        printf("scalar step:  %.2f Mworld-ticks/s\n", (double)worlds * ticks / scalarTime / 1e6);
+        printf("speedup:      %.2fx\n", scalarTime / batchTime);
+    }
+
+    free(states);
+    free(seeds);
+    simBatchFree(batch);
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Feed the fixed-timestep loop jittery, spiky frame times and check that
+// the ticks it hands out add up to the frame time fed in, clamped here
+// independently of FixedStep's own bookkeeping
+static int benchStress(double seconds) {
+    const double maxFrame = 0.25;
+    FixedStep clock;
+    fixedStepInit(clock, SIM_DT, maxFrame);
+
+    SimState state;
+    simInit(state, 12345);
+
+    srand(1);
+    long frames = 0;
+    long spikes = 0;
+    long ticksRun = 0;       // Ticks actually stepped
+    double clampedTime = 0;  // Frame time the ticks should cover
+    double worstFrame = 0;
+    while (clock.realTime < seconds) {
+        // ~60 Hz with +-3 ms jitter, 5% spikes of 50-200 ms, rare 0.5 s stalls
+        double frame = 1.0 / 60 + ((rand() % 61) - 30) * 0.0001;
+        if (rand() % 20 == 0) {
+            frame = 0.05 + (rand() % 150) * 0.001;
+            spikes++;
+        }
+        if (rand() % 500 == 0) {
+            frame = 0.5;
+            spikes++;
+        }
+        if (frame > worstFrame) {
+            worstFrame = frame;
+        }
+
+        clampedTime += frame < maxFrame ? frame : maxFrame;
+        int ticks = fixedStepAdvance(clock, frame);
+        ticksRun += ticks;
+        for (int i = 0; i < ticks; i++) {
+            SimInput input = { botWantsFlap(state) };
+            if (simStep(state, input).died) {
+                simReset(state);
+            }
+        }
+        frames++;
+    }
+
+    // Whatever the ticks missed must still be pending, less than a tick
+    double drift = clampedTime - ticksRun * (double)SIM_DT;
+    bool ok = ticksRun == clock.ticks && fabs(drift) <= SIM_DT + clock.accumulator;
+    double naiveTime = frames * (double)SIM_DT;  // one tick per frame, as before
+    printf("frames:       %ld (%ld spikes, worst %.0f ms)\n", frames, spikes, worstFrame * 1000);
+    printf("real time:    %.3f s\n", clock.realTime);
+    printf("dropped:      %.3f s (frames clamped to %.0f ms)\n", clock.droppedTime, clock.maxFrame * 1000);
+    printf("simulated:    %.3f s in %ld ticks\n", clock.simTime, clock.ticks);
+    printf("pending:      %.4f s\n", clock.accumulator);
+    printf("unsimulated:  %.6f s of clamped frame time (%s)\n", drift,
+           ok ? "within a tick plus pending" : "MISMATCH");
+    printf("tick per frame would have simulated %.3f s (%.1f%% slow)\n",
+           naiveTime, 100.0 * (1.0 - naiveTime / (clock.realTime - clock.droppedTime)));
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "--stress") == 0) {
+        return benchStress(argc > 2 ? atof(argv[2]) : 600);
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--collide") == 0) {
+        return benchCollide(argc > 2 ? atoi(argv[2]) : 100000);
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--lookahead") == 0) {
+        return benchLookahead(argc > 2 ? atoi(argv[2]) : 20,
+                              argc > 3 ? atoi(argv[3]) : LOOKAHEAD_BEAM_WIDTH,
+                              argc > 4 ? atoi(argv[4]) : LOOKAHEAD_DEPTH);
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--levels") == 0) {
+        return benchLevels(argc > 2 ? atol(argv[2]) : 5000000);
+    }
+
+    if (argc > 2 && (strcmp(argv[1], "--batch") == 0 || strcmp(argv[1], "--verify") == 0)) {
+        int worlds = atoi(argv[2]);
+        long ticks = argc > 3 ? atol(argv[3]) : 2000;
+        return benchBatch(worlds, ticks, strcmp(argv[1], "--verify") == 0);
+    }
+
+    long ticks = argc > 1 ? atol(argv[1]) : 20000000;
+    return benchSingle(ticks);
+}
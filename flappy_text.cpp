@@ -0,0 +1,141 @@
+#include "flappy_text.h"
+#include "flappy_render.h"
+#include <stdlib.h>
+#include <math.h>
+
+// Pen position inside each atlas cell, room for descenders below
+#define TEXT_PEN_X 4
+#define TEXT_PEN_Y 8
+
+TextAtlas textAtlas;
+
+bool textAtlasBuild(void (*drawGlyph)(int c), int (*glyphAdvance)(int c)) {
+    int readHeight = TEXT_ROWS * TEXT_CELL;
+
+    // Draw every glyph white on black in its own cell, in window coordinates
+    GLint viewport[4];
+    GLfloat clearColor[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+    glViewport(0, 0, TEXT_ATLAS_WIDTH, readHeight);
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(0, TEXT_ATLAS_WIDTH, 0, readHeight, -1, 1);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    glDisable(GL_BLEND);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glColor3f(1.0f, 1.0f, 1.0f);
+    for (int c = TEXT_FIRST_CHAR; c <= TEXT_LAST_CHAR; c++) {
+        int cell = c - TEXT_FIRST_CHAR;
+        glRasterPos2i((cell % TEXT_COLUMNS) * TEXT_CELL + TEXT_PEN_X,
+                      (cell / TEXT_COLUMNS) * TEXT_CELL + TEXT_PEN_Y);
+        drawGlyph(c);
+    }
+
+    unsigned char* pixels = (unsigned char*)malloc(TEXT_ATLAS_WIDTH * readHeight * 3);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, TEXT_ATLAS_WIDTH, readHeight, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+
+    // Alpha image from the red channel, plus each glyph's tight bounds
+    unsigned char* alpha = (unsigned char*)calloc(TEXT_ATLAS_WIDTH * TEXT_ATLAS_HEIGHT, 1);
+    for (int c = TEXT_FIRST_CHAR; c <= TEXT_LAST_CHAR; c++) {
+        int cell = c - TEXT_FIRST_CHAR;
+        int cellX = (cell % TEXT_COLUMNS) * TEXT_CELL;
+        int cellY = (cell / TEXT_COLUMNS) * TEXT_CELL;
+        int minX = TEXT_CELL, minY = TEXT_CELL, maxX = -1, maxY = -1;
+        for (int y = 0; y < TEXT_CELL; y++) {
+            for (int x = 0; x < TEXT_CELL; x++) {
+                int i = (cellY + y) * TEXT_ATLAS_WIDTH + cellX + x;
+                if (pixels[i * 3] > 127) {
+                    alpha[i] = 255;
+                    if (x < minX) minX = x;
+                    if (x > maxX) maxX = x;
+                    if (y < minY) minY = y;
+                    if (y > maxY) maxY = y;
+                }
+            }
+        }
+
+        Glyph& glyph = textAtlas.glyphs[cell];
+        glyph.advance = glyphAdvance(c);
+        if (maxX < 0) {
+            // Blank (space)
+            glyph.x = glyph.y = glyph.w = glyph.h = 0;
+            glyph.offsetX = glyph.offsetY = 0;
+            continue;
+        }
+        glyph.x = cellX + minX;
+        glyph.y = cellY + minY;
+        glyph.w = maxX - minX + 1;
+        glyph.h = maxY - minY + 1;
+        glyph.offsetX = minX - TEXT_PEN_X;
+        glyph.offsetY = TEXT_PEN_Y - (maxY + 1);  // rows go up, screen y goes down
+    }
+    free(pixels);
+
+    if (textAtlas.texture == 0) {
+        glGenTextures(1, &textAtlas.texture);
+    }
+    glBindTexture(GL_TEXTURE_2D, textAtlas.texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, TEXT_ATLAS_WIDTH, TEXT_ATLAS_HEIGHT, 0,
+                 GL_ALPHA, GL_UNSIGNED_BYTE, alpha);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    free(alpha);
+
+    return glGetError() == GL_NO_ERROR;
+}
+
+void textAtlasFree() {
+    if (textAtlas.texture != 0) {
+        glDeleteTextures(1, &textAtlas.texture);
+        textAtlas.texture = 0;
+    }
+}
+
+void batchText(float x, float y, const char* text) {
+    if (textAtlas.texture == 0) {
+        return;
+    }
+
+    // Snap the pen to whole pixels the way glBitmap does: down in window
+    // coordinates, which is up (towards larger y) on screen
+    float penX, penY;
+    batchTransformPoint(x, y, penX, penY);
+    penX = floor(penX);
+    penY = ceil(penY);
+
+    for (const char* c = text; *c != '\0'; c++) {
+        int code = (unsigned char)*c;
+        if (code < TEXT_FIRST_CHAR || code > TEXT_LAST_CHAR) {
+            continue;
+        }
+        const Glyph& glyph = textAtlas.glyphs[code - TEXT_FIRST_CHAR];
+        if (glyph.w > 0) {
+            float x1 = penX + glyph.offsetX;
+            float y1 = penY + glyph.offsetY;
+            batchTexturedQuad(textAtlas.texture, x1, y1, x1 + glyph.w, y1 + glyph.h,
+                              (float)glyph.x / TEXT_ATLAS_WIDTH,
+                              (float)(glyph.y + glyph.h) / TEXT_ATLAS_HEIGHT,
+                              (float)(glyph.x + glyph.w) / TEXT_ATLAS_WIDTH,
+                              (float)glyph.y / TEXT_ATLAS_HEIGHT);
+        }
+        penX += glyph.advance;
+    }
+}
@@ -0,0 +1,45 @@
+// Glyph-atlas text
+// Glyphs of a bitmap font are rasterized once into an alpha texture, then
+// strings are added to the 2D batch as textured quads, so all the text on
+// screen is drawn with one call instead of a glBitmap per character.
+#ifndef FLAPPY_TEXT_H
+#define FLAPPY_TEXT_H
+
+#include "flappy_gl.h"
+
+#define TEXT_FIRST_CHAR 32
+#define TEXT_LAST_CHAR 126
+#define TEXT_CELL 32  // Atlas cell size in pixels
+#define TEXT_COLUMNS 16
+#define TEXT_ROWS 6
+#define TEXT_ATLAS_WIDTH 512
+#define TEXT_ATLAS_HEIGHT 256
+
+// One character in the atlas
+struct Glyph {
+    int x, y, w, h;          // Rectangle in the atlas texture (rows bottom-up)
+    int offsetX, offsetY;    // Top-left corner relative to the pen, y down
+    int advance;             // Pen movement in pixels
+};
+
+struct TextAtlas {
+    GLuint texture;  // 0 until built
+    Glyph glyphs[TEXT_LAST_CHAR - TEXT_FIRST_CHAR + 1];
+};
+
+extern TextAtlas textAtlas;
+
+// Build the atlas from a bitmap font. drawGlyph(c) must draw character c
+// at the current raster position (e.g. glutBitmapCharacter) and
+// glyphAdvance(c) return its width. The glyphs are drawn into the cleared
+// color buffer, which must be at least TEXT_ATLAS_WIDTH x TEXT_ROWS *
+// TEXT_CELL pixels, and read back; call before drawing the frame.
+bool textAtlasBuild(void (*drawGlyph)(int c), int (*glyphAdvance)(int c));
+void textAtlasFree();
+
+// Add a string to the batch with its baseline starting at (x, y). The pen
+// position goes through the batch transform but glyphs keep their pixel
+// size, like glRasterPos/glBitmap text.
+void batchText(float x, float y, const char* text);
+
+#endif
@@ -0,0 +1,146 @@
+#include "flappy_time.h"
+#include <time.h>
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+
+// Monotonic wall clock in seconds
+double timeNow() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void fixedStepInit(FixedStep& step, double dt, double maxFrame) {
+    step.dt = dt;
+    step.maxFrame = maxFrame;
+    step.accumulator = 0;
+    step.simTime = 0;
+    step.realTime = 0;
+    step.droppedTime = 0;
+    step.ticks = 0;
+}
+
+int fixedStepAdvance(FixedStep& step, double frameSeconds) {
+    if (frameSeconds < 0) {
+        frameSeconds = 0;
+    }
+    step.realTime += frameSeconds;
+
+    // Clamp huge stalls (debugger, window drag) instead of spiralling
+    if (frameSeconds > step.maxFrame) {
+        step.droppedTime += frameSeconds - step.maxFrame;
+        frameSeconds = step.maxFrame;
+    }
+
+    step.accumulator += frameSeconds;
+    int ticks = 0;
+    while (step.accumulator >= step.dt) {
+        step.accumulator -= step.dt;
+        ticks++;
+    }
+    step.ticks += ticks;
+    step.simTime = step.ticks * step.dt;
+    return ticks;
+}
+
+float fixedStepAlpha(const FixedStep& step) {
+    return (float)(step.accumulator / step.dt);
+}
+
+void pacingInit(Pacing& pacing, int idleHz) {
+    pacing.mode = PACING_TIMER;
+    pacing.period = PACING_ACTIVE_MS / 1000.0;
+    pacing.deadline = 0;
+    pacing.idleHz = idleHz > 0 ? idleHz : 0;
+    pacing.busyFrames = 0;
+    pacing.idleFrames = 0;
+    pacing.missed = 0;
+}
+
+void pacingSetMode(Pacing& pacing, PacingMode mode, int hz) {
+    pacing.mode = mode;
+    if (mode == PACING_FIXED && hz > 0) {
+        pacing.period = 1.0 / hz;
+    }
+    pacing.deadline = 0;
+}
+
+int pacingNextFrameMs(Pacing& pacing, bool busy) {
+    if (busy) {
+        pacing.busyFrames++;
+        return PACING_ACTIVE_MS;
+    }
+    pacing.idleFrames++;
+    return pacing.idleHz > 0 ? 1000 / pacing.idleHz : -1;
+}
+
+double pacingWait(Pacing& pacing) {
+    pacing.busyFrames++;
+    if (pacing.mode != PACING_FIXED) {
+        return 0;
+    }
+    double now = timeNow();
+    if (pacing.deadline == 0 || now - pacing.deadline > pacing.period) {
+        // First frame, or back from idle or a stall
+        if (pacing.deadline != 0) {
+            pacing.missed++;
+        }
+        pacing.deadline = now + pacing.period;
+        return 0;
+    }
+    waitUntil(pacing.deadline);
+    double late = timeNow() - pacing.deadline;
+    pacing.deadline += pacing.period;
+    return late;
+}
+
+void waitUntil(double deadline) {
+    double left = deadline - timeNow() - PACING_SPIN_SECONDS;
+    if (left > 0) {
+        struct timespec ts;
+        ts.tv_sec = (time_t)left;
+        ts.tv_nsec = (long)((left - ts.tv_sec) * 1e9);
+        nanosleep(&ts, NULL);
+    }
+    while (timeNow() < deadline) {
+        // Spin out the last stretch
+    }
+}
+
+void frameStatsReset(FrameStats& stats) {
+    stats.last = 0;
+    stats.count = 0;
+}
+
+void frameStatsAdd(FrameStats& stats, double now) {
+    if (stats.last != 0 && stats.count < FRAME_STATS_SAMPLES) {
+        stats.intervals[stats.count++] = now - stats.last;
+    }
+    stats.last = now;
+}
+
+FrameSummary frameStatsSummary(const FrameStats& stats) {
+    FrameSummary summary = {stats.count, 0, 0, 0, 0};
+    if (stats.count == 0) {
+        return summary;
+    }
+    double* sorted = (double*)malloc(stats.count * sizeof(double));
+    double sum = 0;
+    for (int i = 0; i < stats.count; i++) {
+        sum += stats.intervals[i];
+        sorted[i] = stats.intervals[i];
+    }
+    summary.mean = sum / stats.count;
+    double squares = 0;
+    for (int i = 0; i < stats.count; i++) {
+        double d = stats.intervals[i] - summary.mean;
+        squares += d * d;
+    }
+    summary.jitter = sqrt(squares / stats.count);
+    std::sort(sorted, sorted + stats.count);
+    summary.p99 = sorted[(stats.count - 1) * 99 / 100];
+    summary.max = sorted[stats.count - 1];
+    free(sorted);
+    return summary;
+}
@@ -0,0 +1,106 @@
+// Frame timing
+// Monotonic clock and a fixed-timestep accumulator: real frame time is fed
+// in, whole simulation ticks come out, and the leftover fraction is used to
+// interpolate rendering between the previous and current tick.
+#ifndef FLAPPY_TIME_H
+#define FLAPPY_TIME_H
+
+// Monotonic wall clock in seconds
+double timeNow();
+
+struct FixedStep {
+    double dt;           // tick length in seconds
+    double maxFrame;     // longest frame accepted before time is dropped
+    double accumulator;  // real time not yet simulated
+    double simTime;      // total simulated time
+    double realTime;     // total real time fed in
+    double droppedTime;  // real time discarded by the maxFrame clamp
+    long ticks;          // total ticks produced
+};
+
+void fixedStepInit(FixedStep& step, double dt, double maxFrame);
+
+// Feed one frame of real time; returns the number of ticks to run
+int fixedStepAdvance(FixedStep& step, double frameSeconds);
+
+// Fraction of a tick between the last simulated state and now, in [0, 1)
+float fixedStepAlpha(const FixedStep& step);
+
+// Redraw scheduling. While anything moves at game speed (playing,
+// particles, a celebration) frames come at the pacing mode's rate; static
+// screens only drift (sky and clouds), so they are drawn at a lower idle
+// rate, or only on input when that rate is 0.
+//
+// Busy frames in PACING_TIMER mode come from a PACING_ACTIVE_MS timer, as
+// they always have. The other modes run frames back to back: PACING_FIXED
+// waits for a deadline every 1/hz seconds with pacingWait(), PACING_VSYNC
+// leaves the wait to the buffer swap and PACING_UNCAPPED does not wait.
+#define PACING_ACTIVE_MS 16
+#define PACING_IDLE_HZ 20  // Default idle rate
+// pacingWait() sleeps until this long before the deadline and spins for
+// the rest, since sleeps can overshoot by a timer slack or a scheduler
+// quantum
+#define PACING_SPIN_SECONDS 0.002
+
+enum PacingMode {
+    PACING_TIMER,
+    PACING_VSYNC,
+    PACING_FIXED,
+    PACING_UNCAPPED
+};
+
+struct Pacing {
+    PacingMode mode;
+    double period;    // Seconds per frame in PACING_FIXED
+    double deadline;  // Start of the next PACING_FIXED frame, 0 if none yet
+    int idleHz;       // Redraw rate of static screens, 0 for input only
+    long busyFrames;  // Frames scheduled at each rate
+    long idleFrames;
+    long missed;      // PACING_FIXED frames that started a period late
+};
+
+// Timer mode with the given idle rate
+void pacingInit(Pacing& pacing, int idleHz);
+
+// Switch to mode; hz is the target rate of PACING_FIXED
+void pacingSetMode(Pacing& pacing, PacingMode mode, int hz);
+
+// Milliseconds from the end of this frame to the next one, or -1 to wait
+// for input
+int pacingNextFrameMs(Pacing& pacing, bool busy);
+
+// Block until the next busy frame is due: the next deadline in
+// PACING_FIXED, at once in the other modes. Returns how late the frame
+// starts, in seconds. A frame more than a period late starts a new
+// schedule from now instead of rushing to catch up.
+double pacingWait(Pacing& pacing);
+
+// Sleep, then spin, until timeNow() reaches deadline
+void waitUntil(double deadline);
+
+// Frame-time statistics over a window of recent frames
+#define FRAME_STATS_SAMPLES 4096
+
+struct FrameStats {
+    double last;  // Time of the previous frame, 0 before the first
+    double intervals[FRAME_STATS_SAMPLES];
+    int count;
+};
+
+struct FrameSummary {
+    int frames;
+    double mean;    // Seconds between frames
+    double jitter;  // Standard deviation of the intervals
+    double p99;     // 99th percentile interval
+    double max;
+};
+
+void frameStatsReset(FrameStats& stats);
+
+// Record that a frame was presented at time now
+void frameStatsAdd(FrameStats& stats, double now);
+
+// Summarize the intervals since the last reset (zeros if none)
+FrameSummary frameStatsSummary(const FrameStats& stats);
+
+#endif
@@ -0,0 +1,286 @@
+// Neuroevolution trainer
+// Evolves flappy_brain.h policies: every genome of a generation plays the
+// same few levels headlessly under the simulation's own rules, and the
+// fittest are kept and bred with crossover and Gaussian mutation. Games
+// are spread over threads by the work-stealing pool (flappy_pool.h).
+// Each genome's fitness depends only on its weights and the generation,
+// so results do not depend on the thread count.
+//
+// Usage: flappy_train [options]
+//   --generations N   generations to run (default 100)
+//   --population N    genomes per generation (default 256)
+//   --episodes N      levels each genome plays per generation (default 4)
+//   --max-ticks N     ticks after which a game counts as won (default 20000)
+//   --threads N       threads in the pool (default: one per core)
+//   --seed N          seed of the level seeds and of the mutations (default 1)
+//   --out FILE        where to save the best genome (default flappy_brain.txt)
+//   --scaling         time the same generations with 1, 2, 4... threads
+//
+// Play the result with: flappy_bird --autopilot flappy_brain.txt
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "flappy_sim.h"
+#include "flappy_brain.h"
+#include "flappy_pool.h"
+#include "flappy_random.h"
+#include "flappy_time.h"
+
+#define RANDOM_STREAM_TRAIN 3  // Mutation and selection
+
+// Evolution parameters
+#define ELITE_FRACTION 0.1f      // Top genomes copied unchanged
+#define PARENT_FRACTION 0.5f     // Parents come from the top half
+#define TOURNAMENT_SIZE 3
+#define MUTATION_RATE 0.1f       // Chance to mutate each weight
+#define MUTATION_SCALE 0.5f      // Standard deviation of a mutation
+#define INITIAL_SCALE 1.0f       // Standard deviation of the first weights
+#define SCORE_FITNESS 100.0f     // Fitness per pipe passed, on top of ticks
+
+struct TrainConfig {
+    int generations;
+    int population;
+    int episodes;
+    int maxTicks;
+    int threads;
+    unsigned int seed;
+    const char* outPath;
+};
+
+struct Genome {
+    Brain brain;
+    float fitness;
+    int bestScore;
+};
+
+// One generation's evaluation, shared by the pool tasks
+struct Evaluation {
+    Genome* genomes;
+    const TrainConfig* config;
+    unsigned int firstLevelSeed;
+    std::atomic<long> ticks;  // Ticks stepped by all tasks
+};
+
+// Play one level with the policy; fitness is ticks survived plus a bonus
+// per pipe
+static float playEpisode(const Brain& brain, unsigned int levelSeed, int maxTicks,
+                         int& score, long& ticks) {
+    SimState state;
+    simInit(state, levelSeed);
+    while (!state.dead && state.tick < (unsigned int)maxTicks) {
+        SimInput input = { brainWantsFlap(brain, state) };
+        simStep(state, input);
+    }
+    score = state.score;
+    ticks += state.tick;
+    return state.tick + state.score * SCORE_FITNESS;
+}
+
+static void evaluateTask(void* context, int begin, int end) {
+    Evaluation& eval = *(Evaluation*)context;
+    long ticks = 0;
+    for (int g = begin; g < end; g++) {
+        Genome& genome = eval.genomes[g];
+        genome.fitness = 0;
+        genome.bestScore = 0;
+        for (int e = 0; e < eval.config->episodes; e++) {
+            int score;
+            genome.fitness += playEpisode(genome.brain, eval.firstLevelSeed + e,
+                                          eval.config->maxTicks, score, ticks);
+            genome.bestScore = std::max(genome.bestScore, score);
+        }
+        genome.fitness /= eval.config->episodes;
+    }
+    eval.ticks += ticks;
+}
+
+// Standard normal sample (Box-Muller)
+static float gaussian(Random& rng) {
+    float u1 = (randomNext(rng) + 1.0f) / 4294967296.0f;
+    float u2 = randomNext(rng) / 4294967296.0f;
+    return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float)M_PI * u2);
+}
+
+static bool fitter(const Genome& a, const Genome& b) {
+    return a.fitness > b.fitness;
+}
+
+// Best of a few random genomes from the parent pool (sorted, fittest first)
+static const Genome& tournament(const Genome* sorted, int parents, Random& rng) {
+    int best = randomRange(rng, parents);
+    for (int i = 1; i < TOURNAMENT_SIZE; i++) {
+        best = std::min(best, randomRange(rng, parents));
+    }
+    return sorted[best];
+}
+
+// Replace genomes (sorted, fittest first) with the next generation in next
+static void breed(const Genome* sorted, Genome* next, int population, Random& rng) {
+    int elite = std::max(1, (int)(population * ELITE_FRACTION));
+    int parents = std::max(2, (int)(population * PARENT_FRACTION));
+    for (int g = 0; g < elite; g++) {
+        next[g] = sorted[g];
+    }
+    for (int g = elite; g < population; g++) {
+        const Brain& a = tournament(sorted, parents, rng).brain;
+        const Brain& b = tournament(sorted, parents, rng).brain;
+        Brain& child = next[g].brain;
+        for (int w = 0; w < BRAIN_WEIGHTS; w++) {
+            child.weights[w] = randomRange(rng, 2) ? a.weights[w] : b.weights[w];
+            if (randomRange(rng, 1000) < MUTATION_RATE * 1000) {
+                child.weights[w] += gaussian(rng) * MUTATION_SCALE;
+            }
+        }
+    }
+}
+
+// Run the configured generations; fills best and returns the ticks stepped,
+// or -1 if the population does not fit in memory
+static long train(const TrainConfig& config, ThreadPool* pool, Genome& best, bool verbose,
+                  double& elapsed) {
+    Random rng;
+    randomSeed(rng, config.seed, RANDOM_STREAM_TRAIN);
+    Genome* genomes = (Genome*)malloc(config.population * sizeof(Genome));
+    Genome* next = (Genome*)malloc(config.population * sizeof(Genome));
+    if (!genomes || !next) {
+        free(genomes);
+        free(next);
+        return -1;
+    }
+    for (int g = 0; g < config.population; g++) {
+        for (int w = 0; w < BRAIN_WEIGHTS; w++) {
+            genomes[g].brain.weights[w] = gaussian(rng) * INITIAL_SCALE;
+        }
+    }
+
+    Evaluation eval;
+    eval.genomes = genomes;
+    eval.config = &config;
+    long totalTicks = 0;
+    best.fitness = -1;
+    double start = timeNow();
+    for (int gen = 0; gen < config.generations; gen++) {
+        // New levels every generation, so policies cannot learn one layout
+        eval.genomes = genomes;
+        eval.firstLevelSeed = config.seed * 1000003u + gen * config.episodes;
+        eval.ticks = 0;
+        poolParallelFor(pool, config.population, 1, evaluateTask, &eval);
+        totalTicks += eval.ticks;
+
+        std::sort(genomes, genomes + config.population, fitter);
+        if (genomes[0].fitness > best.fitness) {
+            best = genomes[0];
+        }
+        if (verbose) {
+            float mean = 0;
+            for (int g = 0; g < config.population; g++) {
+                mean += genomes[g].fitness;
+            }
+            mean /= config.population;
+            double now = timeNow() - start;
+            printf("gen %4d  best %9.1f  mean %9.1f  best score %5d  %6.2f gen/s\n", gen,
+                   genomes[0].fitness, mean, genomes[0].bestScore, (gen + 1) / now);
+        }
+
+        breed(genomes, next, config.population, rng);
+        std::swap(genomes, next);
+    }
+    elapsed = timeNow() - start;
+
+    free(genomes);
+    free(next);
+    return totalTicks;
+}
+
+// Same run at 1, 2, 4... threads up to the core count
+static int scaling(TrainConfig config) {
+    int cores = (int)std::thread::hardware_concurrency();
+    if (cores < 1) cores = 1;
+    printf("threads  gen/s    Mticks/s  speedup  steals\n");
+    double baseline = 0;
+    for (int threads = 1; ; threads = std::min(threads * 2, cores)) {
+        ThreadPool* pool = poolCreate(threads);
+        Genome best;
+        double elapsed;
+        long ticks = train(config, pool, best, false, elapsed);
+        if (ticks < 0) {
+            printf("out of memory for %d genomes\n", config.population);
+            poolDestroy(pool);
+            return 1;
+        }
+        if (threads == 1) {
+            baseline = elapsed;
+        }
+        printf("%7d  %7.2f  %8.2f  %7.2f  %6ld\n", threads, config.generations / elapsed,
+               ticks / elapsed / 1e6, baseline / elapsed, poolSteals(pool));
+        poolDestroy(pool);
+        if (threads == cores) {
+            break;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    TrainConfig config = { 100, 256, 4, 20000, 0, 1, "flappy_brain.txt" };
+    bool scalingMode = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--generations") == 0 && i + 1 < argc) {
+            config.generations = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--population") == 0 && i + 1 < argc) {
+            config.population = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--episodes") == 0 && i + 1 < argc) {
+            config.episodes = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-ticks") == 0 && i + 1 < argc) {
+            config.maxTicks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            config.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config.seed = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            config.outPath = argv[++i];
+        } else if (strcmp(argv[i], "--scaling") == 0) {
+            scalingMode = true;
+        } else {
+            printf("unknown option %s (see the top of flappy_train.cpp)\n", argv[i]);
+            return 1;
+        }
+    }
+    if (config.generations < 1 || config.population < 4 || config.episodes < 1 ||
+        config.maxTicks < 1) {
+        printf("generations, episodes and max ticks must be positive, population at least 4\n");
+        return 1;
+    }
+
+    if (scalingMode) {
+        return scaling(config);
+    }
+
+    ThreadPool* pool = poolCreate(config.threads);
+    printf("threads %d  population %d  episodes %d  weights %d\n", poolThreadCount(pool),
+           config.population, config.episodes, BRAIN_WEIGHTS);
+    Genome best;
+    double elapsed;
+    long ticks = train(config, pool, best, true, elapsed);
+    if (ticks < 0) {
+        printf("out of memory for %d genomes\n", config.population);
+        poolDestroy(pool);
+        return 1;
+    }
+    printf("%d generations in %.2f s: %.2f gen/s, %.2f Mticks/s, %ld steals\n",
+           config.generations, elapsed, config.generations / elapsed, ticks / elapsed / 1e6,
+           poolSteals(pool));
+    poolDestroy(pool);
+
+    if (!brainSave(best.brain, config.outPath)) {
+        printf("cannot write %s\n", config.outPath);
+        return 1;
+    }
+    printf("best fitness %.1f (score %d), saved to %s\n", best.fitness, best.bestScore,
+           config.outPath);
+    return 0;
+}